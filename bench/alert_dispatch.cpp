@@ -0,0 +1,162 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+// Micro-benchmark of joystream alert dispatch in PluginAlertEncoder::Encoder,
+// comparing the old chain of alert_cast attempts with the type indexed table.
+//
+// Alerts are stand-ins with the same shape as libtorrent alerts (virtual type()),
+// and alert_cast has the same definition as in libtorrent, so no dependencies are needed:
+//
+//  g++ -O2 -std=c++11 bench/alert_dispatch.cpp -o alert_dispatch && ./alert_dispatch
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+  // Matches libtorrent::user_alert_id, where extension alert types start
+  const int user_alert_id = 10000;
+
+  const int num_libtorrent_alert_types = 90;
+  const int num_joystream_alert_types = 25;
+
+  struct alert {
+    virtual ~alert() {}
+    virtual int type() const = 0;
+  };
+
+  template<int Type>
+  struct typed_alert : alert {
+    static const int alert_type = Type;
+    virtual int type() const { return Type; }
+    int payload = Type;
+  };
+
+  template <class T>
+  T const * alert_cast(alert const * a) {
+    if(a == 0) return 0;
+    if(a->type() == T::alert_type) return static_cast<T const *>(a);
+    return 0;
+  }
+
+  template<int N>
+  using joystream_alert = typed_alert<user_alert_id + N>;
+
+  // Stands in for encoding, keeps the cast from being optimized away
+  uint64_t sink = 0;
+
+  template<class T>
+  void encode(T const * p) { sink += p->payload; }
+
+  bool castChainDispatch(alert const * a) {
+
+    #define CAST_CHAIN_ENCODE(n) if(auto p = alert_cast<joystream_alert<n>>(a)) { encode(p); return true; }
+
+    CAST_CHAIN_ENCODE(0)  CAST_CHAIN_ENCODE(1)  CAST_CHAIN_ENCODE(2)  CAST_CHAIN_ENCODE(3)  CAST_CHAIN_ENCODE(4)
+    CAST_CHAIN_ENCODE(5)  CAST_CHAIN_ENCODE(6)  CAST_CHAIN_ENCODE(7)  CAST_CHAIN_ENCODE(8)  CAST_CHAIN_ENCODE(9)
+    CAST_CHAIN_ENCODE(10) CAST_CHAIN_ENCODE(11) CAST_CHAIN_ENCODE(12) CAST_CHAIN_ENCODE(13) CAST_CHAIN_ENCODE(14)
+    CAST_CHAIN_ENCODE(15) CAST_CHAIN_ENCODE(16) CAST_CHAIN_ENCODE(17) CAST_CHAIN_ENCODE(18) CAST_CHAIN_ENCODE(19)
+    CAST_CHAIN_ENCODE(20) CAST_CHAIN_ENCODE(21) CAST_CHAIN_ENCODE(22) CAST_CHAIN_ENCODE(23) CAST_CHAIN_ENCODE(24)
+
+    return false;
+  }
+
+  typedef void (*Encoder)(alert const * a);
+
+  template<class T>
+  void encodeAs(alert const * a) { encode(static_cast<T const *>(a)); }
+
+  std::vector<Encoder> dispatchTable;
+
+  bool tableDispatch(alert const * a) {
+
+    std::size_t i = (std::size_t)(a->type() - user_alert_id);
+
+    if(i < dispatchTable.size() && dispatchTable[i]) {
+      dispatchTable[i](a);
+      return true;
+    }
+
+    return false;
+  }
+
+  template<int N>
+  struct Populate {
+    static void run(std::vector<Encoder> & table, std::vector<std::unique_ptr<alert>> & joystream, std::vector<std::unique_ptr<alert>> & libtorrent) {
+      table[N] = &encodeAs<joystream_alert<N>>;
+      joystream.emplace_back(new joystream_alert<N>());
+      libtorrent.emplace_back(new typed_alert<N>());
+      libtorrent.emplace_back(new typed_alert<N + num_joystream_alert_types>());
+      libtorrent.emplace_back(new typed_alert<N + 2 * num_joystream_alert_types>());
+      Populate<N - 1>::run(table, joystream, libtorrent);
+    }
+  };
+
+  template<>
+  struct Populate<-1> {
+    static void run(std::vector<Encoder> &, std::vector<std::unique_ptr<alert>> &, std::vector<std::unique_ptr<alert>> &) {}
+  };
+
+  template<class F>
+  double nanosecondsPerAlert(const std::vector<alert const *> & stream, int rounds, F dispatch) {
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(int r = 0;r < rounds;r++)
+      for(alert const * a : stream)
+        dispatch(a);
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / (double(stream.size()) * rounds);
+  }
+
+}
+
+int main() {
+
+  static_assert(3 * num_joystream_alert_types <= num_libtorrent_alert_types, "libtorrent stand-ins overlap");
+
+  std::vector<std::unique_ptr<alert>> joystreamAlerts, libtorrentAlerts;
+
+  dispatchTable.assign(num_joystream_alert_types, nullptr);
+  Populate<num_joystream_alert_types - 1>::run(dispatchTable, joystreamAlerts, libtorrentAlerts);
+
+  const std::size_t streamLength = 100000;
+  const int rounds = 100;
+
+  std::mt19937 rng(42);
+
+  std::printf("%-22s %-16s %-16s %s\n", "joystream fraction", "cast chain (ns)", "table (ns)", "speedup");
+
+  for(double fraction : {0.0, 0.1, 0.3, 0.5, 0.9}) {
+
+    // Mixed stream of joystream and other libtorrent alerts
+    std::bernoulli_distribution isJoystream(fraction);
+    std::uniform_int_distribution<std::size_t> pickJoystream(0, joystreamAlerts.size() - 1);
+    std::uniform_int_distribution<std::size_t> pickLibtorrent(0, libtorrentAlerts.size() - 1);
+
+    std::vector<alert const *> stream;
+    stream.reserve(streamLength);
+
+    for(std::size_t i = 0;i < streamLength;i++)
+      stream.push_back(isJoystream(rng) ? joystreamAlerts[pickJoystream(rng)].get() : libtorrentAlerts[pickLibtorrent(rng)].get());
+
+    double chain = nanosecondsPerAlert(stream, rounds, castChainDispatch);
+    double table = nanosecondsPerAlert(stream, rounds, tableDispatch);
+
+    std::printf("%-22.1f %-16.2f %-16.2f %.1fx\n", fraction, chain, table, chain / table);
+  }
+
+  // Print sink so encoding is observable
+  std::fprintf(stderr, "checksum %llu\n", (unsigned long long)sink);
+
+  return 0;
+}
@@ -2,6 +2,17 @@ var Session = require('./dist/Session')
 var joystream = require('bindings')('JoyStreamAddon').joystream
 var libtorrent = require('bindings')('JoyStreamAddon').libtorrent
 
+// Wraps native method taking a node style callback as last argument in a promise
+function promisify (method) {
+  return function () {
+    const args = Array.prototype.slice.call(arguments)
+
+    return new Promise((resolve, reject) => {
+      method.apply(null, args.concat((err, result) => err ? reject(err) : resolve(result)))
+    })
+  }
+}
+
 module.exports = {
   // Libtorrent Interaction mode
   LibtorrentInteraction: joystream.LibtorrentInteraction,
@@ -15,12 +26,54 @@ module.exports = {
   BuyingState: joystream.BuyingState,
   SellingState: joystream.SellingState,
 
+  // Joystream alert types
+  AlertType: joystream.AlertType,
+
+  // Categories of joystream alerts, for Session.setAlertSubscriptions
+  AlertCategory: joystream.AlertCategory,
+
+  // Stages of paid pieces in 'pieceLatencySamples' events
+  PieceLatencyStage: joystream.PieceLatencyStage,
+
   // BEPSupport
   BEPSupportStatus: joystream.BEPSupportStatus,
 
   // Torrent State
   TorrentState: libtorrent.TorrentState,
 
+  // Whether info hashes and peer ids in joystream alerts and statuses are
+  // 20 byte Buffers rather than hex strings. Session assumes hex strings, so this is
+  // only for direct users of the plugin. Plugin methods accept either form.
+  setEncodeHashesAsBuffers: joystream.setEncodeHashesAsBuffers,
+
+  // Current time, in microseconds, on the monotonic clock of the timestamp of joystream alerts
+  alertTimestampNow: joystream.alertTimestampNow,
+
+  // Native log file, joystream.log, written on a background thread and rotated.
+  // configure({path, maxSize, maxAge, maxFiles}) with maxSize in bytes and maxAge
+  // in seconds, stats() returns {written, dropped, truncated, rotations}
+  log: {
+    Level: joystream.LogLevel,
+    setLevel: joystream.setLogLevel,
+    configure: joystream.configureLog,
+    write: joystream.writeLog,
+    stats: joystream.logStats
+  },
+
+  // Native counters and histograms. metrics([snapshot]) returns {counters, histograms}
+  // as Float64Arrays, refilling a previous snapshot if one is passed, and
+  // metricsLayout() gives their names, histogram stride and bucket lower bounds
+  metrics: joystream.metrics,
+  metricsLayout: joystream.metricsLayout,
+
+  // Opt in Chrome Trace Event JSON of native spans, of request submission, alert encoding
+  // by alert type, status encoding and callbacks, along with alert processing by Session.
+  // stopTrace([path]) writes trace to path, or returns it, open in chrome://tracing or Perfetto
+  startTrace: joystream.startTrace,
+  stopTrace: joystream.stopTrace,
+  traceBegin: joystream.traceBegin,
+  traceEnd: joystream.traceEnd,
+
   // Classes
   TorrentInfo: libtorrent.TorrentInfo,
   Session: Session,
@@ -28,6 +81,19 @@ module.exports = {
   // Payment channel, helper methods
   paymentChannel: {
     commitmentToOutput: joystream.commitmentToOutput,
-    createSettlementTransaction: joystream.createSettlementTransaction
+    createSettlementTransaction: joystream.createSettlementTransaction,
+
+    // Same as above, but signing and key derivation happens off the main thread,
+    // returns promise of the same result
+    commitmentToOutputAsync: promisify(joystream.commitmentToOutputAsync),
+    commitmentsToOutputs: promisify(joystream.commitmentsToOutputs),
+    createSettlementTransactionAsync: promisify(joystream.createSettlementTransactionAsync),
+
+    // Settlement transactions of many channels at once, in parallel, returns promise
+    // of {results, errors} where either results[i] or errors[i] is set for each channel
+    createSettlementTransactions: promisify(joystream.createSettlementTransactions),
+
+    // Hit and miss counters of cache of public keys derived from private keys
+    publicKeyCacheStats: joystream.publicKeyCacheStats
   }
 }
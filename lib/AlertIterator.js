@@ -0,0 +1,114 @@
+'use strict'
+
+/*
+ * Class AlertIterator
+ * Async iterator over alerts popped by a session, for consumers which process
+ * alerts at their own pace rather than through events. The session pops and processes
+ * alerts as usual whatever the pace of its iterators. Once an iterator holds
+ * highWaterMark unconsumed alerts, each new alert drops the oldest one, so a slow
+ * consumer loses alerts, counted in dropped, rather than growing memory without bound.
+ */
+
+class AlertIterator {
+
+  constructor (session, {highWaterMark = 1000, filter} = {}) {
+    this._session = session
+    this._highWaterMark = Math.max(highWaterMark, 1)
+    this._filter = filter
+    this._buffer = []
+    this._head = 0
+    this._pendingNext = null
+    this._done = false
+
+    // Alerts dropped because consumer was behind
+    this.dropped = 0
+  }
+
+  /**
+   * Number of buffered alerts.
+   * @return {number}
+   */
+  get length () {
+    return this._buffer.length - this._head
+  }
+
+  next () {
+    if (this.length > 0) {
+      const value = this._buffer[this._head]
+
+      this._buffer[this._head++] = undefined
+      this._compact()
+
+      return Promise.resolve({value: value, done: false})
+    }
+
+    if (this._done) {
+      return Promise.resolve({value: undefined, done: true})
+    }
+
+    return new Promise((resolve) => {
+      this._pendingNext = resolve
+    })
+  }
+
+  /**
+   * Stop iterating, buffered alerts are dropped.
+   */
+  return () {
+    this._done = true
+    this._buffer = []
+    this._head = 0
+
+    this._session._removeAlertIterator(this)
+
+    if (this._pendingNext) {
+      this._pendingNext({value: undefined, done: true})
+      this._pendingNext = null
+    }
+
+    return Promise.resolve({value: undefined, done: true})
+  }
+
+  _dropOldest () {
+    this._buffer[this._head++] = undefined
+    this.dropped++
+    this._compact()
+  }
+
+  // Compact once consumed prefix dominates
+  _compact () {
+    if (this._head > 1024 && this._head * 2 > this._buffer.length) {
+      this._buffer = this._buffer.slice(this._head)
+      this._head = 0
+    }
+  }
+
+  _push (alert) {
+    if (this._done || (this._filter && !this._filter(alert))) {
+      return
+    }
+
+    // Hand alert straight to waiting consumer
+    if (this._pendingNext) {
+      const resolve = this._pendingNext
+
+      this._pendingNext = null
+      resolve({value: alert, done: false})
+      return
+    }
+
+    if (this.length >= this._highWaterMark) {
+      this._dropOldest()
+    }
+
+    this._buffer.push(alert)
+  }
+}
+
+if (typeof Symbol.asyncIterator === 'symbol') {
+  AlertIterator.prototype[Symbol.asyncIterator] = function () {
+    return this
+  }
+}
+
+module.exports = AlertIterator
@@ -5,14 +5,44 @@ var Libtorrent = require('bindings')('JoyStreamAddon').libtorrent
 var debug = require('debug')
 const EventEmitter = require('events')
 const Torrent = require('./Torrent')
+const AlertIterator = require('./AlertIterator')
 const assert = require('assert')
 
 const minimumMessageId = 60
-const popAlertInterval = 100 // 100ms
-const statusUpdateInterval = 1000 // 1 second
+const defaultStatusUpdateInterval = 1000 // 1 second
 const DHTAnnounceInterval = 2 * 60 * 1000 // 2 minutes
 const DHTGetPeersInterval = 30 * 1000 // 30 seconds
 
+// Handlers of joystream alerts routed natively to their torrent, by alert type
+const routedAlertHandlers = []
+
+routedAlertHandlers[JoyStreamAddon.AlertType.ConnectionAddedToSession] = (torrent, alert) => torrent._onConnectionAdded(alert.pid, alert.status)
+routedAlertHandlers[JoyStreamAddon.AlertType.ConnectionRemovedFromSession] = (torrent, alert) => torrent._onConnectionRemoved(alert.pid)
+routedAlertHandlers[JoyStreamAddon.AlertType.PeerPluginStatusUpdateAlert] = (torrent, alert) => torrent._onPeerPluginStatusUpdate(alert.statuses)
+
+for (const [type, eventName] of [
+  ['SessionStarted', 'sessionStarted'],
+  ['SessionPaused', 'sessionPaused'],
+  ['SessionStopped', 'sessionStopped'],
+  ['SessionToObserveMode', 'sessionToObserveMode'],
+  ['SessionToSellMode', 'sessionToSellMode'],
+  ['SessionToBuyMode', 'sessionToBuyMode'],
+  ['ValidPaymentReceived', 'validPaymentReceived'],
+  ['InvalidPaymentReceived', 'invalidPaymentReceived'],
+  ['BuyerTermsUpdated', 'buyerTermsUpdated'],
+  ['SellerTermsUpdated', 'sellerTermsUpdated'],
+  ['ContractConstructed', 'contractConstructed'],
+  ['SentPayment', 'sentPayment'],
+  ['LastPaymentReceived', 'lastPaymentReceived'],
+  ['InvalidPieceArrived', 'invalidPieceArrived'],
+  ['ValidPieceArrived', 'validPieceArrived'],
+  ['AnchorAnnounced', 'anchorAnnounced'],
+  ['UploadStarted', 'uploadStarted'],
+  ['DownloadStarted', 'downloadStarted']
+]) {
+  routedAlertHandlers[JoyStreamAddon.AlertType[type]] = (torrent, alert) => torrent.emit(eventName, alert)
+}
+
 function isEmptyInfoHash (infoHash) {
   return infoHash === '0000000000000000000000000000000000000000' // 20-bytes (160-bit) all zeros info_hash
 }
@@ -25,37 +55,81 @@ function isEmptyInfoHash (infoHash) {
 
 class Session extends EventEmitter {
 
-  constructor ({port, assistedPeerDiscovery = true}) {
+  constructor ({port, assistedPeerDiscovery = true, batchPaymentAlerts = false, deltaStatusUpdates = false, batchPeerStatuses = false, statusUpdateInterval = defaultStatusUpdateInterval, routeAlerts = false, tracePieceLatency = false, coalesceRequestResults = false}) {
     super()
     this._assistedPeerDiscovery = assistedPeerDiscovery
     this.session = new Libtorrent.Session(port)
     this.plugin = new JoyStreamAddon.Plugin(minimumMessageId)
+
+    // SentPayment, ValidPaymentReceived, SendingPieceToBuyer and ValidPieceArrived alerts
+    // are delivered as a columnar 'paymentAlertBatch' event, rather than per torrent events
+    this._batchPaymentAlerts = batchPaymentAlerts
+    this.plugin.set_payment_alert_batching(batchPaymentAlerts)
+
+    // Plugin and peer status updates are diffed natively, and only changes are delivered,
+    // coalesced over statusUpdateInterval, as 'peerPluginStatusDelta' events on torrents
+    this._deltaStatusUpdates = deltaStatusUpdates
+    this.plugin.set_status_update_deltas(deltaStatusUpdates)
+
+    // Peer statuses of all torrents are taken in one batch after alerts are popped,
+    // rather than delivered as one PeerPluginStatusUpdateAlert per torrent
+    this._batchPeerStatuses = batchPeerStatuses
+    this.plugin.set_peer_status_batching(batchPeerStatuses)
+
+    // Request callbacks are run natively, all at once, once alerts of their pop are
+    // processed, rather than as their RequestResult alert is processed
+    this._coalesceRequestResults = coalesceRequestResults
+    this.plugin.set_request_result_coalescing(coalesceRequestResults)
+
+    // Joystream alerts about a torrent are grouped by torrent natively, and each
+    // torrent gets its group in one 'alerts' event, followed by the usual per alert events.
+    // Groups are delivered after the libtorrent alerts popped with them, or right before
+    // their torrent is removed, so they are no longer interleaved with libtorrent alerts
+    this.plugin.set_alert_routing(routeAlerts)
+
+    // Latency of stages of paid pieces is traced natively, and samples are
+    // delivered as a columnar 'pieceLatencySamples' event after alerts are popped
+    this._tracePieceLatency = tracePieceLatency
+    this.plugin.set_piece_tracing(tracePieceLatency)
+
     this.torrents = new Map()
     this.torrentsBySecondaryHash = new Map()
 
+    // Torrents by native slot, which joystream alerts carry as torrentSlot
+    this._torrentsBySlot = []
+
+    // Routed groups of last pop not yet delivered, by torrent slot
+    this._routedGroups = new Map()
+
+    // Consumers iterating alerts, see alerts()
+    this._alertIterators = new Set()
+
       // Add plugin to session
     this.session.addExtension(this.plugin)
 
-    // Process alerts at regular interval
-    setInterval(() => {
-      // Pop alerts
-      var alerts = this.session.popAlerts()
+    // Process alerts as soon as libtorrent posts them. The notifier wakes up
+    // the event loop when the alert queue goes from empty to non-empty,
+    // so every wakeup must drain the queue.
+    this._alertNotifier = new JoyStreamAddon.AlertNotifier(() => {
+      this._popAlerts()
+    })
 
-      if (alerts.length > 950) {
-        console.log('== Warning: alert queue limit almost reached in last pop alerts interval', alerts.length)
-      }
+    this.session.addExtension(this._alertNotifier)
 
-      // Process alerts
-      for (var i in alerts) {
-        this.process(alerts[i])
+    // Request plugin and peer status updates at regular interval,
+    // torrent plugin statuses are posted for all torrents at once
+    setInterval(() => {
+      if (this._deltaStatusUpdates) {
+        const deltas = this.plugin.take_status_deltas()
+
+        if (deltas) {
+          this._statusDeltas(deltas)
+        }
       }
-    }, popAlertInterval)
 
-    // Request plugin and peer status updates at regular interval
-    setInterval(() => {
-      for (var [infoHash] of this.torrents.entries()) {
-          this.plugin.post_torrent_plugin_status_updates(infoHash)
-          this.plugin.post_peer_plugin_status_updates(infoHash)
+      if (this.torrents.size > 0) {
+        this.plugin.post_torrent_plugin_status_updates()
+        this.plugin.post_peer_plugin_status_updates(Array.from(this.torrents.keys()))
       }
     }, statusUpdateInterval)
 
@@ -155,6 +229,73 @@ class Session extends EventEmitter {
     })
   }
 
+  /**
+   * Restrict which joystream alerts are delivered, all other joystream alerts
+   * are dropped in native code before being encoded. Request results are always delivered.
+   * @param {Array} types - joystream alert types (see AlertType), omit to deliver all alerts.
+   */
+  setAlertFilter (types) {
+    this.plugin.set_alert_filter(types)
+  }
+
+  /**
+   * Subscribe to categories of joystream alerts, alerts in other categories are dropped
+   * in native code before being encoded, e.g. a node which never buys can leave out Buying.
+   * Applies on top of setAlertFilter. Request results are always delivered.
+   * @param {number} mask - AlertCategory values or'ed together, AlertCategory.All by default.
+   */
+  setAlertSubscriptions (mask) {
+    this.plugin.set_alert_subscriptions(mask)
+  }
+
+  /**
+   * Payment and piece rates of each connection over the last 10 seconds, kept natively
+   * from popped alerts, also when those alerts are filtered out or batched.
+   * @param {string} [infoHash] - only connections of this torrent
+   * @return {Object} {torrents, peers, length, satsReceivedPerSecond, satsSentPerSecond,
+   * piecesSentPerSecond, piecesReceivedPerSecond, requestToPayment, arrivalToPayment, torrentIndex}
+   * where every column has an entry for each connection, peers[i] is its peer id,
+   * torrents[torrentIndex[i]] its torrent, and latencies are mean seconds or NaN.
+   */
+  connectionRates (infoHash) {
+    return this.plugin.connection_rates(infoHash)
+  }
+
+  /**
+   * Submit many plugin requests at once, e.g. switching all torrents to sell mode.
+   * All requests are validated before any is submitted.
+   * @param {Array} requests - {method, args} where method is plugin method name, e.g. 'to_sell_mode',
+   * and args its arguments without callback.
+   * @param {callback} Called once all requests are done, with (null, {results, errors}) where
+   * errors[i] is null if requests[i] succeeded.
+   * @return {Promise} of {results, errors} when callback is omitted
+   */
+  submitBatch (requests, callback) {
+    return this.plugin.submit_batch(requests, callback)
+  }
+
+  /**
+   * Async iterator over all alerts, in the order they are popped, except that when
+   * alerts are routed (see routeAlerts) the routed joystream alerts of a pop follow its
+   * other alerts, grouped by torrent. Alerts are still processed by the session as usual,
+   * however slow the consumer is.
+   * @param {Object} options - {highWaterMark = 1000, filter} where highWaterMark bounds
+   * alerts buffered, beyond which the oldest are dropped and counted in iterator.dropped,
+   * and filter is an optional predicate selecting which alerts are buffered.
+   * @return {AlertIterator}
+   */
+  alerts (options) {
+    const iterator = new AlertIterator(this, options)
+
+    this._alertIterators.add(iterator)
+
+    return iterator
+  }
+
+  _removeAlertIterator (iterator) {
+    this._alertIterators.delete(iterator)
+  }
+
   /**
    * Call postTorrentUpdates on session.
    */
@@ -184,6 +325,102 @@ class Session extends EventEmitter {
     this.session.dhtGetPeers(infoHash)
   }
 
+  _popAlerts () {
+    // Pop alerts, spans only recorded while tracing, see startTrace
+    var alerts
+
+    JoyStreamAddon.traceBegin('Session.popAlerts')
+    try {
+      alerts = this.session.popAlerts()
+    } finally {
+      JoyStreamAddon.traceEnd()
+    }
+
+    // All alerts of this pop are encoded, counts them as one pop in alert metrics
+    this.plugin.alert_pop_ended()
+
+    if (alerts.length > 950) {
+      console.log('== Warning: alert queue limit almost reached in last pop alerts', alerts.length)
+    }
+
+    // Alerts routed while popping, delivered once the other alerts are processed
+    const routed = this.plugin.take_routed_alerts()
+
+    this._routedGroups = new Map()
+
+    if (routed) {
+      for (const group of routed) {
+        this._routedGroups.set(group.torrentSlot, group)
+      }
+    }
+
+    // Process alerts
+    JoyStreamAddon.traceBegin('Session.process')
+    try {
+      for (var i in alerts) {
+        this.process(alerts[i])
+      }
+    } finally {
+      JoyStreamAddon.traceEnd()
+    }
+
+    if (this._routedGroups.size > 0) {
+      JoyStreamAddon.traceBegin('Session.routedAlerts')
+      try {
+        for (const slot of this._routedGroups.keys()) {
+          this._routedAlerts(slot)
+        }
+      } finally {
+        JoyStreamAddon.traceEnd()
+      }
+    }
+
+    if (this._coalesceRequestResults) {
+      this.plugin.run_request_results()
+    }
+
+    for (const iterator of this._alertIterators) {
+      for (const alert of alerts) {
+        iterator._push(alert)
+      }
+
+      if (routed) {
+        for (const group of routed) {
+          for (const alert of group.alerts) {
+            iterator._push(alert)
+          }
+        }
+      }
+    }
+
+    // Slots of torrents removed above are no longer referenced
+    this.plugin.recycle_torrent_slots()
+
+    if (this._batchPeerStatuses) {
+      const peerStatuses = this.plugin.take_peer_status_batch()
+
+      if (peerStatuses) {
+        this._peerStatusBatch(peerStatuses)
+      }
+    }
+
+    if (this._tracePieceLatency) {
+      const samples = this.plugin.take_piece_latency_samples()
+
+      if (samples) {
+        this.emit('pieceLatencySamples', samples)
+      }
+    }
+
+    if (this._batchPaymentAlerts) {
+      const batch = this.plugin.take_payment_alert_batch()
+
+      if (batch) {
+        this.emit('paymentAlertBatch', batch)
+      }
+    }
+  }
+
   process (alert) {
     switch (alert.type) {
 
@@ -490,6 +727,13 @@ class Session extends EventEmitter {
     // Add torrent to torrents map
     this.torrents.set(infoHash, torrent)
 
+    // Torrent has no slot if it was already removed in this pop
+    torrent._slot = this.plugin.torrent_slot(infoHash)
+
+    if (torrent._slot !== undefined) {
+      this._torrentsBySlot[torrent._slot] = torrent
+    }
+
     // DHT stuff
     if (this._assistedPeerDiscovery) {
       this.torrentsBySecondaryHash.set(torrent.secondaryInfoHash, infoHash)
@@ -561,7 +805,15 @@ class Session extends EventEmitter {
     alertDebug(infoHash)
 
     if (this.torrents.has(infoHash)) {
-      const secondaryInfoHash = this.torrents.get(infoHash).secondaryInfoHash
+      const torrent = this.torrents.get(infoHash)
+
+      if (torrent._slot !== undefined) {
+        // Routed alerts of this pop would find no torrent after removal
+        this._routedAlerts(torrent._slot)
+        this._torrentsBySlot[torrent._slot] = undefined
+      }
+
+      const secondaryInfoHash = torrent.secondaryInfoHash
       this.torrentsBySecondaryHash.delete(secondaryInfoHash)
 
       this.torrents.delete(infoHash)
@@ -722,66 +974,89 @@ class Session extends EventEmitter {
     }
   }
 
-  _peerPluginStatusUpdateAlert (alert) {
-    const torrentHandle = alert.handle
+  // Torrent of joystream alert, found by slot when alert has one
+  _torrentOf (alert) {
+    if (alert.torrentSlot !== undefined) {
+      return this._torrentsBySlot[alert.torrentSlot]
+    }
 
-    const infoHash = torrentHandle.infoHash()
+    const infoHash = alert.handle.infoHash()
 
     if (isEmptyInfoHash(infoHash)) {
-      return
+      return undefined
     }
 
-    if (this.torrents.has(infoHash)) {
-      const torrent = this.torrents.get(infoHash)
+    return this.torrents.get(infoHash)
+  }
+
+  _peerPluginStatusUpdateAlert (alert) {
+    const torrent = this._torrentOf(alert)
+
+    if (torrent) {
       torrent._onPeerPluginStatusUpdate(alert.statuses)
     }
   }
 
-  _connectionAddedToSession (alert) {
-    var alertDebug = debug('session:connectionAddedToSession')
+  // Delivers routed alerts of torrent in slot, if not yet delivered in this pop
+  _routedAlerts (slot) {
+    const group = this._routedGroups.get(slot)
 
-    const torrentHandle = alert.handle
+    if (group) {
+      this._routedGroups.delete(slot)
 
-    const infoHash = torrentHandle.infoHash()
+      const torrent = this._torrentsBySlot[slot]
 
-    if (isEmptyInfoHash(infoHash)) {
-      return
+      if (torrent) {
+        torrent._onAlerts(group.alerts, routedAlertHandlers)
+      }
     }
+  }
 
-    if (this.torrents.has(infoHash)) {
-      const torrent = this.torrents.get(infoHash)
-      torrent._onConnectionAdded(alert.pid, alert.status)
+  _peerStatusBatch (updates) {
+    for (var update of updates) {
+      const torrent = this.torrents.get(update.infoHash)
+      if (torrent) {
+        torrent._onPeerPluginStatusUpdate(update.statuses)
+      }
     }
   }
 
-  _connectionRemovedFromSession (alert) {
-    var alertDebug = debug('session:connectionRemovedFromSession')
+  _statusDeltas (deltas) {
+    for (var status of deltas.torrents) {
+      const torrent = this.torrents.get(status.infoHash)
+      if (torrent) {
+        torrent._onTorrentPluginStatusUpdate(status)
+      }
+    }
 
-    const torrentHandle = alert.handle
+    for (var delta of deltas.peers) {
+      const torrent = this.torrents.get(delta.infoHash)
+      if (torrent) {
+        torrent._onPeerPluginStatusDelta(delta)
+      }
+    }
+  }
 
-    const infoHash = torrentHandle.infoHash()
+  _connectionAddedToSession (alert) {
+    const torrent = this._torrentOf(alert)
 
-    if (isEmptyInfoHash(infoHash)) {
-      return
+    if (torrent) {
+      torrent._onConnectionAdded(alert.pid, alert.status)
     }
+  }
 
-    if (this.torrents.has(infoHash)) {
-      const torrent = this.torrents.get(infoHash)
+  _connectionRemovedFromSession (alert) {
+    const torrent = this._torrentOf(alert)
+
+    if (torrent) {
       torrent._onConnectionRemoved(alert.pid)
     }
   }
 
   __emitEventOnValidTorrent (eventName, alert) {
-    const torrentHandle = alert.handle
+    const torrent = this._torrentOf(alert)
 
-    const infoHash = torrentHandle.infoHash()
-
-    if (isEmptyInfoHash(infoHash)) {
-      return
-    }
-
-    if (this.torrents.has(infoHash)) {
-      const torrent = this.torrents.get(infoHash)
+    if (torrent) {
       torrent.emit(eventName, alert)
     }
   }
@@ -41,6 +41,10 @@ class Torrent extends EventEmitter {
     this.emit('peerPluginStatusUpdates', statuses)
   }
 
+  _onPeerPluginStatusDelta (delta) {
+    this.emit('peerPluginStatusDelta', delta)
+  }
+
   _onResumeData (buff) {
     this.emit('resumedata', buff)
   }
@@ -105,6 +109,18 @@ class Torrent extends EventEmitter {
     this.emit('readPiece', piece, error)
   }
 
+  _onAlerts (alerts, handlers) {
+    this.emit('alerts', alerts)
+
+    for (const alert of alerts) {
+      const handler = handlers[alert.type]
+
+      if (handler) {
+        handler(this, alert)
+      }
+    }
+  }
+
   // Torrent Plugin Controls
 
   toSellMode (sellerTerms, callback = () => {}) {
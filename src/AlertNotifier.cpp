@@ -0,0 +1,179 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "AlertNotifier.hpp"
+#include "libtorrent-node/utils.hpp"
+
+#include <libtorrent/extensions.hpp>
+#include <libtorrent/session_handle.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <uv.h>
+#include <mutex>
+#include <memory>
+
+#define GET_THIS_NOTIFIER(var) AlertNotifier * var = Nan::ObjectWrap::Unwrap<AlertNotifier>(info.This());
+
+namespace joystream {
+namespace node {
+
+namespace detail {
+
+  /**
+   * @brief Event loop handle shared between the binding and the libtorrent thread.
+   * Memory is kept alive by `self` until the handle has been closed by libuv,
+   * so the notify hook can safely outlive the javascript object.
+   */
+  struct AlertWakeup {
+
+    AlertWakeup(const v8::Local<v8::Function> & fn)
+      : callback(new Nan::Callback(fn))
+      , closed(false) {
+      async.data = this;
+    }
+
+    // Called on libtorrent thread, with alert queue mutex held,
+    // so we can do no more than signal the loop
+    void notify() {
+
+      std::lock_guard<std::mutex> lock(mutex);
+
+      if(!closed)
+        uv_async_send(&async);
+    }
+
+    void close() {
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if(closed)
+          return;
+
+        closed = true;
+      }
+
+      uv_close(reinterpret_cast<uv_handle_t *>(&async), &AlertWakeup::onClose);
+    }
+
+    static void onAsync(uv_async_t * handle) {
+
+      Nan::HandleScope scope;
+
+      AlertWakeup * wakeup = static_cast<AlertWakeup *>(handle->data);
+
+      if(wakeup->callback)
+        wakeup->callback->Call(0, nullptr);
+    }
+
+    static void onClose(uv_handle_t * handle) {
+
+      AlertWakeup * wakeup = static_cast<AlertWakeup *>(handle->data);
+
+      // Persistent handles must be released on the loop thread,
+      // the last reference may be dropped by libtorrent
+      wakeup->callback.reset();
+
+      boost::shared_ptr<AlertWakeup> self;
+      self.swap(wakeup->self);
+    }
+
+    std::unique_ptr<Nan::Callback> callback;
+    std::mutex mutex;
+    bool closed;
+    uv_async_t async;
+    boost::shared_ptr<AlertWakeup> self;
+  };
+
+  class AlertNotifyPlugin : public libtorrent::plugin {
+
+  public:
+
+    AlertNotifyPlugin(const boost::shared_ptr<AlertWakeup> & wakeup)
+      : _wakeup(wakeup) {
+    }
+
+    virtual void added(libtorrent::session_handle h) {
+
+      boost::shared_ptr<AlertWakeup> wakeup = _wakeup;
+
+      // libtorrent calls notify immediately if alerts are already queued
+      h.set_alert_notify([wakeup]() { wakeup->notify(); });
+    }
+
+  private:
+
+    boost::shared_ptr<AlertWakeup> _wakeup;
+  };
+
+  boost::optional<v8::Local<v8::Object>> noAlertEncoder(const libtorrent::alert *) {
+    return boost::optional<v8::Local<v8::Object>>();
+  }
+
+}
+
+Nan::Persistent<v8::Function> AlertNotifier::constructor;
+
+NAN_MODULE_INIT(AlertNotifier::Init) {
+
+  v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+  tpl->SetClassName(Nan::New("AlertNotifier").ToLocalChecked());
+  tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+  Nan::SetPrototypeMethod(tpl, "close", Close);
+
+  constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
+  Nan::Set(target, Nan::New("AlertNotifier").ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
+}
+
+libtorrent::node::AlertEncoder AlertNotifier::getEncoder() const noexcept {
+  return detail::noAlertEncoder;
+}
+
+boost::shared_ptr<libtorrent::plugin> AlertNotifier::getPlugin() const noexcept {
+  return _plugin;
+}
+
+AlertNotifier::AlertNotifier(const boost::shared_ptr<detail::AlertWakeup> & wakeup)
+  : _wakeup(wakeup)
+  , _plugin(boost::make_shared<detail::AlertNotifyPlugin>(wakeup)) {
+}
+
+AlertNotifier::~AlertNotifier() {
+  _wakeup->close();
+}
+
+NAN_METHOD(AlertNotifier::New) {
+
+  NEW_OPERATOR_GUARD(info, constructor)
+  ARGUMENTS_REQUIRE_FUNCTION(0, callback)
+
+  auto wakeup = boost::make_shared<detail::AlertWakeup>(callback);
+
+  if(uv_async_init(uv_default_loop(), &wakeup->async, &detail::AlertWakeup::onAsync) != 0)
+    return Nan::ThrowError("Could not create alert notification handle");
+
+  wakeup->self = wakeup;
+
+  AlertNotifier * n = new AlertNotifier(wakeup);
+
+  n->Wrap(info.This());
+
+  info.GetReturnValue().Set(info.This());
+}
+
+NAN_METHOD(AlertNotifier::Close) {
+
+  GET_THIS_NOTIFIER(notifier)
+
+  notifier->_wakeup->close();
+
+  RETURN_VOID
+}
+
+}
+}
@@ -0,0 +1,64 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_ALERT_NOTIFIER_HPP
+#define JOYSTREAM_NODE_ALERT_NOTIFIER_HPP
+
+#include "libtorrent-node/plugin.hpp"
+
+#include <boost/shared_ptr.hpp>
+
+namespace joystream {
+namespace node {
+namespace detail {
+  struct AlertWakeup;
+}
+
+/**
+ * @brief Session extension which wakes up the node event loop when
+ * alerts are posted.
+ *
+ * When added to a session, the libtorrent alert notify hook is installed.
+ * It signals an uv_async_t handle, and the javascript callback given to
+ * the constructor is then called on the node loop, where alerts can be popped.
+ * The hook is only called when the alert queue goes from empty to non-empty,
+ * hence the callback is expected to pop all alerts every time it is called.
+ *
+ * Javascript
+ *  new AlertNotifier(callback) - callback()
+ *  .close() - stops notifications, and releases event loop handle.
+ */
+class AlertNotifier : public libtorrent::node::plugin {
+
+public:
+
+  static NAN_MODULE_INIT(Init);
+
+  virtual libtorrent::node::AlertEncoder getEncoder() const noexcept;
+
+  virtual boost::shared_ptr<libtorrent::plugin> getPlugin() const noexcept;
+
+private:
+
+  boost::shared_ptr<detail::AlertWakeup> _wakeup;
+
+  boost::shared_ptr<libtorrent::plugin> _plugin;
+
+  AlertNotifier(const boost::shared_ptr<detail::AlertWakeup> & wakeup);
+
+  ~AlertNotifier();
+
+  static Nan::Persistent<v8::Function> constructor;
+
+  static NAN_METHOD(New);
+  static NAN_METHOD(Close);
+
+};
+
+}
+}
+
+#endif // JOYSTREAM_NODE_ALERT_NOTIFIER_HPP
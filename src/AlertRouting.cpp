@@ -0,0 +1,64 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "AlertRouting.hpp"
+#include "libtorrent-node/utils.hpp"
+
+namespace joystream {
+namespace node {
+namespace alert_routing {
+
+  void Groups::route(int32_t slot, const v8::Local<v8::Object> & alert) {
+
+    if(_groups.IsEmpty()) {
+      _groups.Reset(Nan::New<v8::Array>());
+      _alertsOfGroups.Reset(Nan::New<v8::Array>());
+    }
+
+    v8::Local<v8::Array> alertsOf = Nan::New(_alertsOfGroups);
+    v8::Local<v8::Array> alerts;
+
+    auto it = _groupOfSlot.find(slot);
+
+    if(it == _groupOfSlot.end()) {
+
+      v8::Local<v8::Array> g = Nan::New(_groups);
+      uint32_t index = g->Length();
+
+      alerts = Nan::New<v8::Array>();
+
+      v8::Local<v8::Object> group = Nan::New<v8::Object>();
+      SET_NUMBER(group, "torrentSlot", slot);
+      SET_VAL(group, "alerts", alerts);
+
+      Nan::Set(g, index, group);
+      Nan::Set(alertsOf, index, alerts);
+
+      _groupOfSlot.insert(std::make_pair(slot, index));
+
+    } else
+      alerts = v8::Local<v8::Array>::Cast(Nan::Get(alertsOf, it->second).ToLocalChecked());
+
+    Nan::Set(alerts, alerts->Length(), alert);
+  }
+
+  v8::Local<v8::Value> Groups::take() {
+
+    if(_groups.IsEmpty())
+      return Nan::Undefined();
+
+    v8::Local<v8::Array> g = Nan::New(_groups);
+
+    _groups.Reset();
+    _alertsOfGroups.Reset();
+    _groupOfSlot.clear();
+
+    return g;
+  }
+
+}
+}
+}
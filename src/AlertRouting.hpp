@@ -0,0 +1,63 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_ALERT_ROUTING_HPP
+#define JOYSTREAM_NODE_ALERT_ROUTING_HPP
+
+#include <nan.h>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace joystream {
+namespace node {
+namespace alert_routing {
+
+  /*
+   * Grouping of encoded joystream alerts by the torrent they are about,
+   * so javascript can hand each torrent all of its alerts at once, rather
+   * than dispatching every alert on its own.
+   *
+   * Alerts are routed on the node thread while alerts are popped,
+   * and groups are then taken with `take`.
+   */
+
+  class Groups {
+
+  public:
+
+    /* @brief Adds encoded alert to group of torrent
+     *
+     * @param slot torrent slot, see torrent_slots
+     * @param alert encoded alert
+     */
+    void route(int32_t slot, const v8::Local<v8::Object> & alert);
+
+    /* @brief Takes all alerts routed since last call
+     *
+     * @return v8::Local<v8::Value>, undefined if no alerts were routed, otherwise
+     * array with g for each torrent, in order of first alert, where
+     *
+     * {Number} g.torrentSlot - slot of torrent
+     * {Array} g.alerts - alerts about torrent, in order they were popped
+     */
+    v8::Local<v8::Value> take();
+
+  private:
+
+    // Groups outlive the handle scope of the pop which routed them
+    Nan::Global<v8::Array> _groups;
+    Nan::Global<v8::Array> _alertsOfGroups;
+
+    // Index of group of each slot in groups
+    std::unordered_map<int32_t, uint32_t> _groupOfSlot;
+  };
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_ALERT_ROUTING_HPP
@@ -0,0 +1,40 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "AlertTimestamp.hpp"
+#include "libtorrent-node/utils.hpp"
+
+#include <libtorrent/alert.hpp>
+#include <libtorrent/time.hpp>
+
+namespace joystream {
+namespace node {
+namespace alert_timestamp {
+
+  namespace {
+
+    double encode(const libtorrent::time_point & t) {
+      return (double)libtorrent::total_microseconds(t.time_since_epoch());
+    }
+
+    NAN_METHOD(Now) {
+      RETURN(Nan::New<v8::Number>(encode(libtorrent::clock_type::now())))
+    }
+
+  }
+
+  NAN_MODULE_INIT(Init) {
+    Nan::Set(target, Nan::New("alertTimestampNow").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(Now)->GetFunction());
+  }
+
+  double encode(const libtorrent::alert * a) {
+    return encode(a->timestamp());
+  }
+
+}
+}
+}
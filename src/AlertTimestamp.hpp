@@ -0,0 +1,42 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_ALERT_TIMESTAMP_HPP
+#define JOYSTREAM_NODE_ALERT_TIMESTAMP_HPP
+
+#include <nan.h>
+
+namespace libtorrent {
+  class alert;
+}
+
+namespace joystream {
+namespace node {
+namespace alert_timestamp {
+
+  /*
+   * Timestamps of alerts, as microseconds on the monotonic high resolution
+   * clock of libtorrent, taken when the alert was raised on the network thread.
+   * Only differences between timestamps, or with alertTimestampNow, are meaningful.
+   * The clock has an arbitrary epoch per machine, so timestamps of two nodes cannot
+   * be compared or joined.
+   */
+
+  // Exports "alertTimestampNow" () returning current time on the same clock
+  NAN_MODULE_INIT(Init);
+
+  /* @brief Timestamp of alert
+   *
+   * @param a alert
+   * @return microseconds
+   */
+  double encode(const libtorrent::alert * a);
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_ALERT_TIMESTAMP_HPP
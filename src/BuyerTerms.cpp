@@ -6,6 +6,7 @@
  */
 
 #include "BuyerTerms.hpp"
+#include "ObjectShape.hpp"
 #include "libtorrent-node/utils.hpp"
 
 #include <protocol_wire/protocol_wire.hpp>
@@ -19,14 +20,18 @@ namespace joystream {
 namespace node {
 namespace buyer_terms {
 
+enum Key { MaxPrice, MaxLock, MinNumberOfSellers, MaxContractFeePerKb };
+
 v8::Local<v8::Value> encode(const protocol_wire::BuyerTerms & terms) {
 
-  v8::Local<v8::Object> o = Nan::New<v8::Object>();
+  static const ObjectShape shape({MAX_PRICE_KEY, MAX_LOCK_KEY, MIN_NUMBER_OF_SELLERS_KEY, MAX_CONTRACT_FEE_PER_KB_KEY});
+
+  v8::Local<v8::Object> o = shape.NewInstance();
 
-  SET_NUMBER(o, MAX_PRICE_KEY, terms.maxPrice());
-  SET_UINT32(o, MAX_LOCK_KEY, terms.maxLock());
-  SET_UINT32(o, MIN_NUMBER_OF_SELLERS_KEY, terms.minNumberOfSellers());
-  SET_NUMBER(o, MAX_CONTRACT_FEE_PER_KB_KEY, terms.maxContractFeePerKb());
+  shape.Set(o, MaxPrice, Nan::New<v8::Number>(terms.maxPrice()));
+  shape.Set(o, MaxLock, Nan::New<v8::Uint32>(terms.maxLock()));
+  shape.Set(o, MinNumberOfSellers, Nan::New<v8::Uint32>(terms.minNumberOfSellers()));
+  shape.Set(o, MaxContractFeePerKb, Nan::New<v8::Number>(terms.maxContractFeePerKb()));
 
   return o;
 }
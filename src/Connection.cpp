@@ -8,13 +8,17 @@
 #include "Connection.hpp"
 #include "libtorrent-node/utils.hpp"
 #include "libtorrent-node/endpoint.hpp"
-#include "libtorrent-node/peer_id.hpp"
+#include "Hashes.hpp"
 #include "SellerTerms.hpp"
 #include "BuyerTerms.hpp"
 #include "OutPoint.hpp"
 #include "Signature.hpp"
 #include "PublicKey.hpp"
 #include "PubKeyHash.hpp"
+#include "ObjectShape.hpp"
+
+#include <array>
+#include <unordered_map>
 
 namespace joystream {
 namespace node {
@@ -53,6 +57,11 @@ namespace connection {
       STATE_TO_TYPE_INFO(ProcessingPiece)
   };
 
+  // Index of each state in InnerStateTypeInfo, and its encoding,
+  // built once by InitInnerStateTypes
+  static std::unordered_map<std::type_index, uint32_t> InnerStateIndexes;
+  static std::array<v8::Eternal<v8::Uint32>, std::tuple_size<decltype(InnerStateTypeInfo)>::value> InnerStateValues;
+
   NAN_MODULE_INIT(InitInnerStateTypes);
 
   NAN_MODULE_INIT(Init) {
@@ -65,20 +74,26 @@ namespace connection {
 
     v8::Local<v8::Object> o = Nan::New<v8::Object>();
 
-    for(std::size_t i = 0;i < InnerStateTypeInfo.size();i++)
+    for(std::size_t i = 0;i < InnerStateTypeInfo.size();i++) {
       SET_NUMBER(o, InnerStateTypeInfo[i].second, (uint32_t)i);
 
+      InnerStateIndexes.insert(std::make_pair(InnerStateTypeInfo[i].first, (uint32_t)i));
+      InnerStateValues[i].Set(v8::Isolate::GetCurrent(), Nan::New<v8::Uint32>((uint32_t)i));
+    }
 
     SET_VAL(target, "InnerStateType", o);
   }
 
   v8::Local<v8::Uint32> encode(const std::type_index & index){
+    return InnerStateValues[innerStateIndex(index)].Get(v8::Isolate::GetCurrent());
+  }
 
-    for(std::size_t i = 0;i < InnerStateTypeInfo.size();i++) {
+  uint32_t innerStateIndex(const std::type_index & index) {
 
-      if(InnerStateTypeInfo[i].first == index)
-        return Nan::New<v8::Uint32>((uint32_t)i);
-    }
+    auto it = InnerStateIndexes.find(index);
+
+    if(it != InnerStateIndexes.end())
+      return it->second;
 
     // Should never get here, means our code is out of synch
     // with structure of statemachine. We throw exception to detect, since
@@ -129,49 +144,68 @@ namespace connection {
     return o;
   }
 
+  namespace payor_key {
+    enum { Price, NumberOfPaymentsMade, Funds, SettlementFee, RefundLockTime, Anchor, SellerContractPk };
+  }
+
   v8::Local<v8::Object> encode(const paymentchannel::Payor & payor) {
 
-    v8::Local<v8::Object> o = Nan::New<v8::Object>();
+    static const ObjectShape shape({"price", "numberOfPaymentsMade", "funds", "settlementFee", "refundLockTime", "anchor", "sellerContractPk"});
+
+    v8::Local<v8::Object> o = shape.NewInstance();
 
-    SET_NUMBER(o, "price", payor.price());
-    SET_NUMBER(o, "numberOfPaymentsMade", payor.numberOfPaymentsMade());
-    SET_NUMBER(o, "funds", payor.funds());
-    SET_NUMBER(o, "settlementFee", payor.settlementFee());
-    SET_NUMBER(o, "refundLockTime", payor.refundLockTime().counter());
-    SET_VAL(o, "anchor", outpoint::encode(payor.anchor()));
-    SET_VAL(o, "sellerContractPk", public_key::encode(payor.payeeContractPk()));
+    shape.Set(o, payor_key::Price, Nan::New<v8::Number>(payor.price()));
+    shape.Set(o, payor_key::NumberOfPaymentsMade, Nan::New<v8::Number>(payor.numberOfPaymentsMade()));
+    shape.Set(o, payor_key::Funds, Nan::New<v8::Number>(payor.funds()));
+    shape.Set(o, payor_key::SettlementFee, Nan::New<v8::Number>(payor.settlementFee()));
+    shape.Set(o, payor_key::RefundLockTime, Nan::New<v8::Number>(payor.refundLockTime().counter()));
+    shape.Set(o, payor_key::Anchor, outpoint::encode(payor.anchor()));
+    shape.Set(o, payor_key::SellerContractPk, public_key::encode(payor.payeeContractPk()));
 
     return o;
   }
 
+  namespace payee_key {
+    enum { Price, NumberOfPaymentsMade, Funds, SettlementFee, RefundLockTime, Anchor, LastValidPayorPaymentSignature, BuyerContractPk, BuyerFinalPkHash };
+  }
+
   v8::Local<v8::Object> encode(const paymentchannel::Payee & payee) {
 
-    v8::Local<v8::Object> o = Nan::New<v8::Object>();
+    static const ObjectShape shape({"price", "numberOfPaymentsMade", "funds", "settlementFee", "refundLockTime", "anchor",
+                                    "lastValidPayorPaymentSignature", "buyerContractPk", "buyerFinalPkHash"});
 
-    SET_NUMBER(o, "price", payee.price());
-    SET_NUMBER(o, "numberOfPaymentsMade", payee.numberOfPaymentsMade());
-    SET_NUMBER(o, "funds", payee.numberOfPaymentsMade());
-    SET_NUMBER(o, "settlementFee", payee.settlementFee());
-    SET_NUMBER(o, "refundLockTime", payee.lockTime().counter());
-    SET_VAL(o, "anchor", outpoint::encode(payee.contractOutPoint()));
-    SET_VAL(o, "lastValidPayorPaymentSignature", signature::encode(payee.lastValidPayorPaymentSignature()));
-    SET_VAL(o, "buyerContractPk", public_key::encode(payee.payorContractPk()));
-    SET_VAL(o, "buyerFinalPkHash", pubkey_hash::encode(payee.payorFinalPkHash()));
+    v8::Local<v8::Object> o = shape.NewInstance();
+
+    shape.Set(o, payee_key::Price, Nan::New<v8::Number>(payee.price()));
+    shape.Set(o, payee_key::NumberOfPaymentsMade, Nan::New<v8::Number>(payee.numberOfPaymentsMade()));
+    shape.Set(o, payee_key::Funds, Nan::New<v8::Number>(payee.numberOfPaymentsMade()));
+    shape.Set(o, payee_key::SettlementFee, Nan::New<v8::Number>(payee.settlementFee()));
+    shape.Set(o, payee_key::RefundLockTime, Nan::New<v8::Number>(payee.lockTime().counter()));
+    shape.Set(o, payee_key::Anchor, outpoint::encode(payee.contractOutPoint()));
+    shape.Set(o, payee_key::LastValidPayorPaymentSignature, signature::encode(payee.lastValidPayorPaymentSignature()));
+    shape.Set(o, payee_key::BuyerContractPk, public_key::encode(payee.payorContractPk()));
+    shape.Set(o, payee_key::BuyerFinalPkHash, pubkey_hash::encode(payee.payorFinalPkHash()));
 
     return o;
   }
 
+  namespace connection_key {
+    enum { Pid, InnerState, Payor, Payee, AnnouncedModeAndTermsFromPeer };
+  }
+
   v8::Local<v8::Object> encode(const joystream::protocol_session::status::Connection<libtorrent::peer_id>& c) {
 
-    v8::Local<v8::Object> o = Nan::New<v8::Object>();
+    static const ObjectShape shape({"pid", "innerState", "payor", "payee", "announcedModeAndTermsFromPeer"});
+
+    v8::Local<v8::Object> o = shape.NewInstance();
 
-    SET_VAL(o, "pid", libtorrent::node::peer_id::encode(c.connectionId));
+    shape.Set(o, connection_key::Pid, hashes::encodePeerId(c.connectionId));
 
     // machine
-    SET_VAL(o, "innerState", encode(c.machine.innerStateTypeIndex));
-    SET_VAL(o, "payor", encode(c.machine.payor));
-    SET_VAL(o, "payee", encode(c.machine.payee));
-    SET_VAL(o, "announcedModeAndTermsFromPeer", encode(c.machine.announcedModeAndTermsFromPeer));
+    shape.Set(o, connection_key::InnerState, encode(c.machine.innerStateTypeIndex));
+    shape.Set(o, connection_key::Payor, encode(c.machine.payor));
+    shape.Set(o, connection_key::Payee, encode(c.machine.payee));
+    shape.Set(o, connection_key::AnnouncedModeAndTermsFromPeer, encode(c.machine.announcedModeAndTermsFromPeer));
 
     //std::queue<uint32_t> downloadedValidPieces;
 
@@ -35,6 +35,14 @@ namespace connection {
   */
   v8::Local<v8::Uint32> encode(const std::type_index & i);
 
+  /* @brief Value of inner state in InnerStateType, as used by encode above.
+   *
+   * @param i type_index object for state class
+   * @return uint32_t index of state
+   * @throws std::runtime_error if state is not recognized
+   */
+  uint32_t innerStateIndex(const std::type_index & i);
+
   /* @brief Creates javascript representation of protocol_statemachine::AnnouncedModeAndTerms.
    *
    * @param a to be encoded
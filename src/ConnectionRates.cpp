@@ -0,0 +1,254 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "ConnectionRates.hpp"
+#include "libtorrent-node/utils.hpp"
+#include "Hashes.hpp"
+
+#include <extension/extension.hpp>
+#include <libtorrent/alert_types.hpp>
+#include <libtorrent/time.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace joystream {
+namespace node {
+namespace connection_rates {
+
+  namespace {
+
+    // libtorrent helpers, as clock is boost::chrono or std::chrono depending on version
+    int64_t secondOf(const libtorrent::time_point & t) {
+      return libtorrent::total_seconds(t.time_since_epoch());
+    }
+
+    double secondsBetween(const libtorrent::time_point & from, const libtorrent::time_point & to) {
+      return libtorrent::total_microseconds(to - from) / 1e6;
+    }
+
+    typedef std::pair<libtorrent::sha1_hash, libtorrent::peer_id> Key;
+
+    typedef std::map<Key, Connection>::const_iterator Iterator;
+
+    v8::Local<v8::Object> encode(Iterator begin, Iterator end) {
+
+      int64_t now = secondOf(libtorrent::clock_type::now());
+
+      std::vector<libtorrent::sha1_hash> torrents;
+      std::vector<libtorrent::peer_id> peers;
+      std::vector<uint32_t> torrentIndex;
+
+      std::size_t n = 0;
+
+      for(Iterator it = begin;it != end;it++, n++) {
+
+        if(torrents.empty() || torrents.back() != it->first.first)
+          torrents.push_back(it->first.first);
+
+        torrentIndex.push_back((uint32_t)torrents.size() - 1);
+        peers.push_back(it->first.second);
+      }
+
+      // Float64 columns come first, so every view is aligned
+      const std::size_t NumberOfFloat64Columns = 6;
+
+      v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), n * (NumberOfFloat64Columns * sizeof(double) + sizeof(uint32_t)));
+      char * data = static_cast<char *>(buffer->GetContents().Data());
+
+      double * columns[NumberOfFloat64Columns];
+
+      for(std::size_t c = 0;c < NumberOfFloat64Columns;c++)
+        columns[c] = reinterpret_cast<double *>(data) + c * n;
+
+      uint32_t * torrentIndexColumn = reinterpret_cast<uint32_t *>(data + NumberOfFloat64Columns * n * sizeof(double));
+
+      std::size_t i = 0;
+
+      for(Iterator it = begin;it != end;it++, i++) {
+
+        const Connection & c = it->second;
+
+        columns[0][i] = c.rate(c.satsReceived, now);
+        columns[1][i] = c.rate(c.satsSent, now);
+        columns[2][i] = c.rate(c.piecesSent, now);
+        columns[3][i] = c.rate(c.piecesReceived, now);
+        columns[4][i] = c.mean(c.requestToPaymentSum, c.requestToPaymentCount, now);
+        columns[5][i] = c.mean(c.arrivalToPaymentSum, c.arrivalToPaymentCount, now);
+      }
+
+      if(n > 0)
+        std::memcpy(torrentIndexColumn, torrentIndex.data(), n * sizeof(uint32_t));
+
+      v8::Local<v8::Array> torrentList = Nan::New<v8::Array>();
+      for(auto & h : torrents)
+        torrentList->Set(torrentList->Length(), hashes::encodeInfoHash(h));
+
+      v8::Local<v8::Array> peerList = Nan::New<v8::Array>();
+      for(auto & pid : peers)
+        peerList->Set(peerList->Length(), hashes::encodePeerId(pid));
+
+      v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+      SET_VAL(o, "torrents", torrentList);
+      SET_VAL(o, "peers", peerList);
+      SET_NUMBER(o, "length", n);
+      SET_VAL(o, "buffer", buffer);
+
+      std::size_t offset = 0;
+
+      #define SET_FLOAT64_COLUMN(name) SET_VAL(o, #name, v8::Float64Array::New(buffer, offset, n)); offset += n * sizeof(double);
+
+      SET_FLOAT64_COLUMN(satsReceivedPerSecond)
+      SET_FLOAT64_COLUMN(satsSentPerSecond)
+      SET_FLOAT64_COLUMN(piecesSentPerSecond)
+      SET_FLOAT64_COLUMN(piecesReceivedPerSecond)
+      SET_FLOAT64_COLUMN(requestToPayment)
+      SET_FLOAT64_COLUMN(arrivalToPayment)
+
+      #undef SET_FLOAT64_COLUMN
+
+      SET_VAL(o, "torrentIndex", v8::Uint32Array::New(buffer, offset, n));
+
+      return o;
+    }
+
+  }
+
+  Window::Window() {
+    _seconds.fill(std::numeric_limits<int64_t>::min());
+    _sums.fill(0);
+  }
+
+  void Window::add(int64_t second, double value) {
+
+    std::size_t i = (std::size_t)(second % WindowSeconds);
+
+    if(_seconds[i] != second) {
+      _seconds[i] = second;
+      _sums[i] = 0;
+    }
+
+    _sums[i] += value;
+  }
+
+  double Window::sum(int64_t now) const {
+
+    double total = 0;
+
+    for(std::size_t i = 0;i < _sums.size();i++)
+      if(_seconds[i] <= now && _seconds[i] > now - WindowSeconds)
+        total += _sums[i];
+
+    return total;
+  }
+
+  Connection::Connection(int64_t firstSecond)
+    : firstSecond(firstSecond) {
+  }
+
+  double Connection::rate(const Window & w, int64_t now) const {
+    return w.sum(now) / (double)std::max<int64_t>(1, std::min<int64_t>(WindowSeconds, now - firstSecond + 1));
+  }
+
+  double Connection::mean(const Window & sum, const Window & count, int64_t now) const {
+
+    double n = count.sum(now);
+
+    return n > 0 ? sum.sum(now) / n : std::nan("");
+  }
+
+  Connection & Rates::connectionOf(const libtorrent::peer_alert * p) {
+
+    Key key(p->handle.info_hash(), p->pid);
+
+    auto it = _connections.find(key);
+
+    if(it == _connections.end())
+      it = _connections.insert(std::make_pair(key, Connection(secondOf(p->timestamp())))).first;
+
+    return it->second;
+  }
+
+  void Rates::removeTorrent(const libtorrent::sha1_hash & infoHash) {
+
+    // Zero peer id sorts first
+    auto it = _connections.lower_bound(Key(infoHash, libtorrent::peer_id()));
+
+    while(it != _connections.end() && it->first.first == infoHash)
+      it = _connections.erase(it);
+  }
+
+  boost::optional<piece_progress::Ended> Rates::observe(const libtorrent::alert * a) {
+
+    boost::optional<piece_progress::Ended> ended;
+
+    if(auto p = libtorrent::alert_cast<extension::alert::ConnectionRemovedFromSession>(a)) {
+      _connections.erase(Key(p->handle.info_hash(), p->pid));
+      return ended;
+    } else if(auto p = libtorrent::alert_cast<libtorrent::torrent_removed_alert>(a)) {
+      removeTorrent(p->info_hash);
+      return ended;
+    }
+
+    Connection * c = nullptr;
+
+    if(auto p = libtorrent::alert_cast<extension::alert::ValidPaymentReceived>(a)) {
+      c = &connectionOf(p);
+      c->satsReceived.add(secondOf(p->timestamp()), (double)p->paymentIncrement);
+    } else if(auto p = libtorrent::alert_cast<extension::alert::SentPayment>(a)) {
+      c = &connectionOf(p);
+      c->satsSent.add(secondOf(p->timestamp()), (double)p->paymentIncrement);
+    } else if(auto p = libtorrent::alert_cast<extension::alert::SendingPieceToBuyer>(a)) {
+      c = &connectionOf(p);
+      c->piecesSent.add(secondOf(p->timestamp()), 1);
+    } else if(auto p = libtorrent::alert_cast<extension::alert::ValidPieceArrived>(a)) {
+      c = &connectionOf(p);
+      c->piecesReceived.add(secondOf(p->timestamp()), 1);
+    } else if(auto p = libtorrent::alert_cast<extension::alert::PieceRequestedByBuyer>(a))
+      c = &connectionOf(p);
+    else
+      return ended;
+
+    ended = c->pieces.observe(a);
+
+    if(ended) {
+
+      int64_t second = secondOf(ended->end);
+
+      if(ended->stage == piece_progress::Stage::SendToPayment && ended->requested) {
+        c->requestToPaymentSum.add(second, secondsBetween(*ended->requested, ended->end));
+        c->requestToPaymentCount.add(second, 1);
+      } else if(ended->stage == piece_progress::Stage::ArrivalToPayment) {
+        c->arrivalToPaymentSum.add(second, secondsBetween(ended->start, ended->end));
+        c->arrivalToPaymentCount.add(second, 1);
+      }
+    }
+
+    return ended;
+  }
+
+  v8::Local<v8::Object> Rates::encode() const {
+    return connection_rates::encode(_connections.cbegin(), _connections.cend());
+  }
+
+  v8::Local<v8::Object> Rates::encode(const libtorrent::sha1_hash & infoHash) const {
+
+    Iterator begin = _connections.lower_bound(Key(infoHash, libtorrent::peer_id()));
+    Iterator end = begin;
+
+    while(end != _connections.cend() && end->first.first == infoHash)
+      end++;
+
+    return connection_rates::encode(begin, end);
+  }
+
+}
+}
+}
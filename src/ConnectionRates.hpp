@@ -0,0 +1,143 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_CONNECTION_RATES_HPP
+#define JOYSTREAM_NODE_CONNECTION_RATES_HPP
+
+#include <nan.h>
+
+#include "PieceProgress.hpp"
+
+#include <libtorrent/sha1_hash.hpp>
+
+#include <array>
+#include <map>
+#include <utility>
+
+namespace libtorrent {
+  class alert;
+  struct peer_alert;
+}
+
+namespace joystream {
+namespace node {
+namespace connection_rates {
+
+  /*
+   * Rolling aggregates of payments and pieces of each connection, over the
+   * last WindowSeconds seconds, so pricing logic can read rates rather than
+   * replay payment alerts.
+   *
+   * Aggregates are updated from every popped ValidPaymentReceived, SentPayment,
+   * SendingPieceToBuyer, ValidPieceArrived and PieceRequestedByBuyer alert,
+   * whether or not the alert is delivered to javascript, and are timed by when
+   * the alert was raised on the network thread rather than when it was popped.
+   * Pieces in progress of each connection are kept here too, see piece_progress,
+   * and a connection is forgotten when ConnectionRemovedFromSession or
+   * torrent_removed_alert is popped.
+   */
+
+  // Length of rolling window
+  const int WindowSeconds = 10;
+
+  /**
+   * Sums of values added in each of the last WindowSeconds whole seconds,
+   * where the sum of a second is reset when the slot is reused.
+   */
+  class Window {
+
+  public:
+
+    Window();
+
+    void add(int64_t second, double value);
+
+    // Sum of seconds in (now - WindowSeconds, now]
+    double sum(int64_t now) const;
+
+  private:
+
+    std::array<int64_t, WindowSeconds> _seconds;
+    std::array<double, WindowSeconds> _sums;
+  };
+
+  struct Connection {
+
+    Connection(int64_t firstSecond);
+
+    // Rate over window, or over lifetime of connection if shorter
+    double rate(const Window & w, int64_t now) const;
+
+    double mean(const Window & sum, const Window & count, int64_t now) const;
+
+    int64_t firstSecond;
+
+    Window satsReceived;
+    Window satsSent;
+    Window piecesSent;
+    Window piecesReceived;
+
+    Window requestToPaymentSum;
+    Window requestToPaymentCount;
+    Window arrivalToPaymentSum;
+    Window arrivalToPaymentCount;
+
+    piece_progress::Pieces pieces;
+  };
+
+  class Rates {
+
+  public:
+
+    /* @brief Updates aggregates and pieces of connection of alert, if alert is one of the above
+     *
+     * @param a alert
+     * @return stage of a piece ended by alert, if any
+     */
+    boost::optional<piece_progress::Ended> observe(const libtorrent::alert * a);
+
+    /* @brief Creates javascript representation of aggregates of all connections
+     *
+     * @return v8::Local<v8::Object> o where
+     *
+     * {Array} o.torrents - info hashes referred to by torrentIndex
+     * {Array} o.peers - peer id of each connection
+     * {Number} o.length - number of connections
+     * {ArrayBuffer} o.buffer - backing store of all columns below
+     * {Float64Array} o.satsReceivedPerSecond - amount of ValidPaymentReceived
+     * {Float64Array} o.satsSentPerSecond - amount of SentPayment
+     * {Float64Array} o.piecesSentPerSecond - SendingPieceToBuyer
+     * {Float64Array} o.piecesReceivedPerSecond - ValidPieceArrived
+     * {Float64Array} o.requestToPayment - mean seconds from PieceRequestedByBuyer to
+     *   the ValidPaymentReceived paying for the piece, NaN without payments in window
+     * {Float64Array} o.arrivalToPayment - mean seconds from ValidPieceArrived to
+     *   SentPayment for the same piece, NaN without payments in window
+     * {Uint32Array} o.torrentIndex - index into o.torrents
+     */
+    v8::Local<v8::Object> encode() const;
+
+    /* @brief Same as encode, for connections of one torrent
+     *
+     * @param infoHash torrent
+     */
+    v8::Local<v8::Object> encode(const libtorrent::sha1_hash & infoHash) const;
+
+  private:
+
+    typedef std::pair<libtorrent::sha1_hash, libtorrent::peer_id> Key;
+
+    Connection & connectionOf(const libtorrent::peer_alert * p);
+
+    void removeTorrent(const libtorrent::sha1_hash & infoHash);
+
+    std::map<Key, Connection> _connections;
+  };
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_CONNECTION_RATES_HPP
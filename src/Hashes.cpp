@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "Hashes.hpp"
+#include "buffers.hpp"
+#include "libtorrent-node/utils.hpp"
+#include "libtorrent-node/sha1_hash.hpp"
+#include "libtorrent-node/peer_id.hpp"
+
+namespace joystream {
+namespace node {
+namespace hashes {
+
+  namespace {
+
+    const std::size_t HashSize = 20;
+
+    // Only ever touched on node thread
+    bool encodeAsBuffers = false;
+
+    NAN_METHOD(SetEncodeHashesAsBuffers) {
+
+      ARGUMENTS_REQUIRE_BOOLEAN(0, enable)
+
+      encodeAsBuffers = enable;
+
+      RETURN_VOID
+    }
+
+    // Reads hash straight from buffer memory
+    libtorrent::sha1_hash fromBuffer(const v8::Local<v8::Value> & v) {
+
+      auto view = NodeBufferToView(v);
+
+      if(view.size != HashSize)
+        throw std::runtime_error("hash buffer must be 20 bytes");
+
+      return libtorrent::sha1_hash(reinterpret_cast<const char *>(view.data));
+    }
+
+  }
+
+  NAN_MODULE_INIT(Init) {
+
+    Nan::Set(target, Nan::New("setEncodeHashesAsBuffers").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(SetEncodeHashesAsBuffers)->GetFunction());
+  }
+
+  libtorrent::sha1_hash decodeInfoHash(const v8::Local<v8::Value> & v) {
+
+    if(v->IsUint8Array())
+      return fromBuffer(v);
+
+    return libtorrent::node::sha1_hash::decode(v);
+  }
+
+  libtorrent::peer_id decodePeerId(const v8::Local<v8::Value> & v) {
+
+    if(v->IsUint8Array())
+      return fromBuffer(v);
+
+    return libtorrent::node::peer_id::decode(v);
+  }
+
+  v8::Local<v8::Value> encodeInfoHash(const libtorrent::sha1_hash & h) {
+
+    if(encodeAsBuffers)
+      return Nan::CopyBuffer(h.data(), HashSize).ToLocalChecked();
+
+    return libtorrent::node::sha1_hash::encode(h);
+  }
+
+  v8::Local<v8::Value> encodePeerId(const libtorrent::peer_id & pid) {
+
+    if(encodeAsBuffers)
+      return Nan::CopyBuffer(pid.data(), HashSize).ToLocalChecked();
+
+    return libtorrent::node::peer_id::encode(pid);
+  }
+
+}
+}
+}
@@ -0,0 +1,61 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_HASHES_HPP
+#define JOYSTREAM_NODE_HASHES_HPP
+
+#include <nan.h>
+#include <libtorrent/sha1_hash.hpp>
+#include <libtorrent/peer_id.hpp>
+
+namespace joystream {
+namespace node {
+namespace hashes {
+
+  /*
+   * Info hashes and peer ids are represented in javascript either as 40 character
+   * hex strings, or as 20 byte node Buffers, which are read and made without
+   * any parsing or formatting. Decoding accepts both, encoding produces
+   * hex strings unless set to produce buffers.
+   */
+
+  // Exports
+  // - "setEncodeHashesAsBuffers" (Boolean) which sets whether hashes in
+  // alerts and statuses are encoded as node Buffers
+  NAN_MODULE_INIT(Init);
+
+  /* @brief Converts info hash from hex string or 20 byte node Buffer/Uint8Array
+   * @param {v8::Local<v8::Value>}
+   * @return {libtorrent::sha1_hash}
+   * @throws std::runtime_error if conversion fails
+   */
+  libtorrent::sha1_hash decodeInfoHash(const v8::Local<v8::Value> & v);
+
+  /* @brief Converts peer id from hex string or 20 byte node Buffer/Uint8Array
+   * @param {v8::Local<v8::Value>}
+   * @return {libtorrent::peer_id}
+   * @throws std::runtime_error if conversion fails
+   */
+  libtorrent::peer_id decodePeerId(const v8::Local<v8::Value> & v);
+
+  /* @brief Creates javascript representation of info hash
+   * @param {const libtorrent::sha1_hash &}
+   * @return {v8::Local<v8::Value>} hex string, or node Buffer when set to encode as buffers
+   */
+  v8::Local<v8::Value> encodeInfoHash(const libtorrent::sha1_hash & h);
+
+  /* @brief Creates javascript representation of peer id
+   * @param {const libtorrent::peer_id &}
+   * @return {v8::Local<v8::Value>} same as libtorrent::node::peer_id::encode, or
+   * node Buffer when set to encode as buffers
+   */
+  v8::Local<v8::Value> encodePeerId(const libtorrent::peer_id & pid);
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_HASHES_HPP
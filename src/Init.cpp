@@ -10,11 +10,18 @@
 #include "RequestResult.hpp"
 #include "Connection.hpp"
 #include "Plugin.hpp"
+#include "AlertNotifier.hpp"
 #include "PeerPluginStatus.hpp"
 #include "TorrentPluginStatus.hpp"
 #include "payment_channel.hpp"
 #include "BEPSupportStatus.hpp"
 #include "Session.hpp"
+#include "Hashes.hpp"
+#include "Logging.hpp"
+#include "Metrics.hpp"
+#include "AlertTimestamp.hpp"
+#include "PieceTracer.hpp"
+#include "Tracing.hpp"
 
 namespace joystream {
 namespace node {
@@ -25,10 +32,17 @@ namespace node {
     peer_plugin_status::Init(target);
     torrent_plugin_status::Init(target);
     Plugin::Init(target);
+    AlertNotifier::Init(target);
     payment_channel::Init(target);
     bep_support_status::Init(target);
     connection::Init(target);
     session::Init(target);
+    hashes::Init(target);
+    logging::Init(target);
+    metrics::Init(target);
+    alert_timestamp::Init(target);
+    piece_tracer::Init(target);
+    tracing::Init(target);
   }
 
 }
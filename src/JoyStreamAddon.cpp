@@ -7,14 +7,13 @@
 
 #include <libtorrent-node/init.hpp>
 #include "Init.hpp"
+#include "Logging.hpp"
 
 #include <iostream>
-#include <fstream>
 
 NAN_MODULE_INIT(InitJoyStreamAddon) {
-    // redirect std::clog output to logfile
-    auto logfile = new std::ofstream("joystream.log");
-    std::clog.rdbuf(logfile->rdbuf());
+    // redirect std::clog output to asynchronous, rotating log file
+    joystream::node::logging::start("joystream.log");
 
     std::clog << "Loading JoyStream Addon" << std::endl;
 
@@ -0,0 +1,173 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "LazyAlert.hpp"
+#include "libtorrent-node/utils.hpp"
+#include "libtorrent-node/endpoint.hpp"
+#include "Hashes.hpp"
+#include "libtorrent-node/torrent_handle.h"
+
+#include <libtorrent/alert_types.hpp>
+
+#include <map>
+
+#define UNWRAP_HOLDER(var) LazyAlert * var = Nan::ObjectWrap::Unwrap<LazyAlert>(info.Holder());
+
+namespace joystream {
+namespace node {
+
+namespace {
+
+  // Constructor for each alert type defined
+  std::map<int, std::unique_ptr<Nan::Persistent<v8::Function>>> constructors;
+
+}
+
+void LazyAlert::DefineType(int type, const std::vector<const char *> & fields) {
+
+  v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+
+  v8::Local<v8::ObjectTemplate> itpl = tpl->InstanceTemplate();
+  itpl->SetInternalFieldCount(1);
+
+  // Accessors are defined on instance
+  Nan::SetAccessor(itpl, Nan::New("type").ToLocalChecked(), Type);
+  Nan::SetAccessor(itpl, Nan::New("what").ToLocalChecked(), What);
+  Nan::SetAccessor(itpl, Nan::New("message").ToLocalChecked(), Message);
+  Nan::SetAccessor(itpl, Nan::New("category").ToLocalChecked(), Category);
+
+  // Field index is passed as accessor data
+  for(uint32_t i = 0;i < fields.size();i++)
+    Nan::SetAccessor(itpl, Nan::New(fields[i]).ToLocalChecked(), Field, 0, Nan::New<v8::Uint32>(i));
+
+  std::unique_ptr<Nan::Persistent<v8::Function>> constructor(new Nan::Persistent<v8::Function>());
+  constructor->Reset(Nan::GetFunction(tpl).ToLocalChecked());
+
+  constructors[type] = std::move(constructor);
+}
+
+v8::Local<v8::Object> LazyAlert::NewInstance(const libtorrent::alert * a, std::vector<FieldEncoder> && encoders) {
+
+  auto it = constructors.find(a->type());
+
+  // Should never get here, means alert type was not defined in module init
+  if(it == constructors.end())
+    throw std::runtime_error("alert type has no lazy handle, bad build!");
+
+  v8::Local<v8::Function> constructor = Nan::New(*it->second);
+  v8::Local<v8::Object> o = Nan::NewInstance(constructor).ToLocalChecked();
+
+  LazyAlert * alert = Nan::ObjectWrap::Unwrap<LazyAlert>(o);
+
+  alert->_type = a->type();
+  alert->_what = a->what();
+  alert->_message = a->message();
+  alert->_category = a->category();
+  alert->_encoders = std::move(encoders);
+  alert->_values.reset(new Nan::Global<v8::Value>[alert->_encoders.size()]);
+
+  return o;
+}
+
+std::vector<const char *> LazyAlert::TorrentAlertFields(std::initializer_list<const char *> fields) {
+
+  std::vector<const char *> v = {"handle"};
+  v.insert(v.end(), fields);
+
+  return v;
+}
+
+std::vector<const char *> LazyAlert::PeerAlertFields(std::initializer_list<const char *> fields) {
+
+  std::vector<const char *> v = {"handle", "ip", "pid"};
+  v.insert(v.end(), fields);
+
+  return v;
+}
+
+std::vector<LazyAlert::FieldEncoder> LazyAlert::TorrentAlertEncoders(const libtorrent::torrent_alert * a, std::initializer_list<FieldEncoder> encoders) {
+
+  libtorrent::torrent_handle h = a->handle;
+
+  std::vector<FieldEncoder> v = {
+    [h]() mutable -> v8::Local<v8::Value> { return TorrentHandle::New(h); }
+  };
+
+  v.insert(v.end(), encoders);
+
+  return v;
+}
+
+std::vector<LazyAlert::FieldEncoder> LazyAlert::PeerAlertEncoders(const libtorrent::peer_alert * a, std::initializer_list<FieldEncoder> encoders) {
+
+  libtorrent::torrent_handle h = a->handle;
+  libtorrent::tcp::endpoint ip = a->ip;
+  libtorrent::peer_id pid = a->pid;
+
+  std::vector<FieldEncoder> v = {
+    [h]() mutable -> v8::Local<v8::Value> { return TorrentHandle::New(h); },
+    [ip]() -> v8::Local<v8::Value> { return libtorrent::node::endpoint::encode(ip); },
+    [pid]() -> v8::Local<v8::Value> { return hashes::encodePeerId(pid); }
+  };
+
+  v.insert(v.end(), encoders);
+
+  return v;
+}
+
+NAN_METHOD(LazyAlert::New) {
+
+  if(!info.IsConstructCall())
+    return Nan::ThrowError("Constructor must be called with new");
+
+  (new LazyAlert())->Wrap(info.This());
+
+  RETURN(info.This())
+}
+
+NAN_GETTER(LazyAlert::Type) {
+
+  UNWRAP_HOLDER(alert)
+  RETURN(Nan::New(alert->_type))
+}
+
+NAN_GETTER(LazyAlert::What) {
+
+  UNWRAP_HOLDER(alert)
+  RETURN(Nan::New(alert->_what).ToLocalChecked())
+}
+
+NAN_GETTER(LazyAlert::Message) {
+
+  UNWRAP_HOLDER(alert)
+  RETURN(Nan::New(alert->_message).ToLocalChecked())
+}
+
+NAN_GETTER(LazyAlert::Category) {
+
+  UNWRAP_HOLDER(alert)
+  RETURN(Nan::New(alert->_category))
+}
+
+NAN_GETTER(LazyAlert::Field) {
+
+  UNWRAP_HOLDER(alert)
+
+  uint32_t i = Nan::To<uint32_t>(info.Data()).FromJust();
+
+  Nan::Global<v8::Value> & value = alert->_values[i];
+
+  // Encode on first read, and release whatever the encoder captured
+  if(value.IsEmpty()) {
+    value.Reset(alert->_encoders[i]());
+    alert->_encoders[i] = nullptr;
+  }
+
+  RETURN(Nan::New(value))
+}
+
+}
+}
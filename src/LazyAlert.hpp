@@ -0,0 +1,93 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_LAZY_ALERT_HPP
+#define JOYSTREAM_NODE_LAZY_ALERT_HPP
+
+#include <nan.h>
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace libtorrent {
+  class alert;
+  struct torrent_alert;
+  struct peer_alert;
+}
+
+namespace joystream {
+namespace node {
+
+/**
+ * @brief Thin handle for an alert, where fields are only encoded
+ * when first read from javascript, and then cached on the handle.
+ *
+ * Fields are copied out of the alert when the handle is created, since
+ * the alert itself does not outlive the pop_alerts call. Every handle
+ * has the plain `type`, `what`, `message` and `category` fields, remaining
+ * fields are defined per alert type with DefineType.
+ */
+class LazyAlert : public Nan::ObjectWrap {
+
+public:
+
+  typedef std::function<v8::Local<v8::Value>()> FieldEncoder;
+
+  /* @brief Defines fields of handles for alerts of given type,
+   * must be called during module initialization.
+   *
+   * @param type alert type
+   * @param fields names of fields, in the same order as encoders given to NewInstance
+   */
+  static void DefineType(int type, const std::vector<const char *> & fields);
+
+  /* @brief Creates handle for alert, type of alert must have been defined.
+   *
+   * @param a alert
+   * @param encoders field encoders, one for each field given to DefineType
+   */
+  static v8::Local<v8::Object> NewInstance(const libtorrent::alert * a, std::vector<FieldEncoder> && encoders);
+
+  /* @brief Field names shared by all torrent alerts ("handle") and
+   * peer alerts ("handle", "ip", "pid"), followed by `fields`.
+   */
+  static std::vector<const char *> TorrentAlertFields(std::initializer_list<const char *> fields);
+  static std::vector<const char *> PeerAlertFields(std::initializer_list<const char *> fields);
+
+  /* @brief Encoders for the shared fields above, followed by `encoders`.
+   */
+  static std::vector<FieldEncoder> TorrentAlertEncoders(const libtorrent::torrent_alert * a, std::initializer_list<FieldEncoder> encoders);
+  static std::vector<FieldEncoder> PeerAlertEncoders(const libtorrent::peer_alert * a, std::initializer_list<FieldEncoder> encoders);
+
+private:
+
+  // Alert fields
+  int _type;
+  char const * _what;
+  std::string _message;
+  int _category;
+
+  // Pending encoders, and values of fields already read, which
+  // are released along with the handle
+  std::vector<FieldEncoder> _encoders;
+  std::unique_ptr<Nan::Global<v8::Value>[]> _values;
+
+  // We do not export this constructor
+  static NAN_METHOD(New);
+
+  static NAN_GETTER(Type);
+  static NAN_GETTER(What);
+  static NAN_GETTER(Message);
+  static NAN_GETTER(Category);
+  static NAN_GETTER(Field);
+};
+
+}
+}
+
+#endif // JOYSTREAM_NODE_LAZY_ALERT_HPP
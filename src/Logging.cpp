@@ -0,0 +1,592 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "Logging.hpp"
+#include "libtorrent-node/utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+
+namespace joystream {
+namespace node {
+namespace logging {
+
+  namespace {
+
+    // Ring of 2048 slots of about 512 bytes, about 1MB
+    const std::size_t RingSize = 2048;
+    const std::size_t LineSize = 480;
+
+    // How long writer sleeps when ring is empty
+    const std::chrono::milliseconds PollInterval(50);
+
+    const char * LevelNames[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+
+    struct Slot {
+
+      // Position in ring the slot is ready for, see Ring
+      std::atomic<std::size_t> sequence;
+
+      Level level;
+      uint16_t size;
+      std::chrono::system_clock::time_point time;
+      char data[LineSize];
+    };
+
+    /**
+     * Bounded multi producer single consumer queue, where each slot
+     * carries the sequence number of the push or pop it is ready for,
+     * so producers only contend on one counter, and never wait on the consumer.
+     */
+    class Ring {
+
+    public:
+
+      Ring()
+        : _slots(new Slot[RingSize])
+        , _pushPosition(0)
+        , _popPosition(0) {
+
+        for(std::size_t i = 0;i < RingSize;i++)
+          _slots[i].sequence.store(i, std::memory_order_relaxed);
+      }
+
+      // Returns false if ring is full
+      bool push(Level level, const char * data, std::size_t size, bool & truncated) {
+
+        std::size_t position = _pushPosition.load(std::memory_order_relaxed);
+        Slot * slot;
+
+        for(;;) {
+
+          slot = &_slots[position % RingSize];
+
+          std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+          std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+
+          if(difference == 0) {
+            if(_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+              break;
+          } else if(difference < 0)
+            return false;
+          else
+            position = _pushPosition.load(std::memory_order_relaxed);
+        }
+
+        truncated = size > LineSize;
+
+        slot->level = level;
+        slot->size = (uint16_t)std::min(size, LineSize);
+        slot->time = std::chrono::system_clock::now();
+        std::memcpy(slot->data, data, slot->size);
+
+        slot->sequence.store(position + 1, std::memory_order_release);
+
+        return true;
+      }
+
+      // Only called by writer thread, returns null if ring is empty
+      const Slot * front() const {
+
+        const Slot * slot = &_slots[_popPosition % RingSize];
+
+        if(slot->sequence.load(std::memory_order_acquire) != _popPosition + 1)
+          return nullptr;
+
+        return slot;
+      }
+
+      // Only called by writer thread, after front
+      void pop() {
+        _slots[_popPosition % RingSize].sequence.store(_popPosition + RingSize, std::memory_order_release);
+        _popPosition++;
+      }
+
+    private:
+
+      std::unique_ptr<Slot[]> _slots;
+      std::atomic<std::size_t> _pushPosition;
+      std::size_t _popPosition;
+    };
+
+    struct Configuration {
+
+      Configuration()
+        : maxSize(10 * 1024 * 1024)
+        , maxAge(0)
+        , maxFiles(5) {
+      }
+
+      std::string path;
+
+      // Bytes, 0 for no limit
+      uint64_t maxSize;
+
+      // Seconds, 0 for no limit
+      uint64_t maxAge;
+
+      // Rotated files kept
+      uint32_t maxFiles;
+    };
+
+    class Writer {
+
+    public:
+
+      Writer()
+        : _reopen(false)
+        , _stopping(false)
+        , _openPending(false)
+        , _fileSize(0) {
+      }
+
+      void start(const Configuration & configuration) {
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if(_thread.joinable())
+          return;
+
+        _configuration = configuration;
+        _reopen = true;
+        _thread = std::thread(&Writer::run, this);
+      }
+
+      // Writes everything queued before returning
+      void stop() {
+
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+
+          if(!_thread.joinable())
+            return;
+
+          _stopping = true;
+        }
+
+        _wakeup.notify_one();
+        _thread.join();
+      }
+
+      void configure(const Configuration & configuration) {
+
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+
+          _reopen = _reopen || configuration.path != _configuration.path;
+          _configuration = configuration;
+        }
+
+        _wakeup.notify_one();
+      }
+
+      Configuration configuration() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _configuration;
+      }
+
+      Ring ring;
+
+      std::atomic<uint64_t> written{0};
+      std::atomic<uint64_t> dropped{0};
+      std::atomic<uint64_t> truncated{0};
+      std::atomic<uint64_t> rotations{0};
+
+    private:
+
+      void run() {
+
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        for(;;) {
+
+          Configuration configuration = _configuration;
+          bool reopen = _reopen;
+          bool stopping = _stopping;
+
+          _reopen = false;
+
+          lock.unlock();
+
+          // Only opened once there is a line to write, so that a path configured
+          // before the first line is written is the only file created
+          if(reopen) {
+            _file.close();
+            _openPending = true;
+          }
+
+          bool wrote = drain(configuration);
+
+          if(stopping) {
+            _file.close();
+            return;
+          }
+
+          lock.lock();
+
+          if(!wrote && !_reopen && !_stopping)
+            _wakeup.wait_for(lock, PollInterval);
+        }
+      }
+
+      void open(const std::string & path, std::ios::openmode mode) {
+
+        _file.close();
+        _file.clear();
+        _file.open(path, std::ios::out | mode);
+
+        // Retried by next drain if it failed
+        _openPending = !_file.is_open();
+
+        _fileSize = 0;
+        _opened = std::chrono::system_clock::now();
+      }
+
+      void rotate(const Configuration & configuration) {
+
+        _file.close();
+
+        // <path>.n-1 -> <path>.n, ..., <path> -> <path>.1
+        if(configuration.maxFiles > 0) {
+
+          std::remove((configuration.path + "." + std::to_string(configuration.maxFiles)).c_str());
+
+          for(uint32_t i = configuration.maxFiles - 1;i > 0;i--)
+            std::rename((configuration.path + "." + std::to_string(i)).c_str(),
+                        (configuration.path + "." + std::to_string(i + 1)).c_str());
+
+          std::rename(configuration.path.c_str(), (configuration.path + ".1").c_str());
+        }
+
+        open(configuration.path, std::ios::trunc);
+
+        rotations++;
+      }
+
+      bool rotationDue(const Configuration & configuration, const std::chrono::system_clock::time_point & now) const {
+        return (configuration.maxSize > 0 && _fileSize >= configuration.maxSize) ||
+               (configuration.maxAge > 0 && now - _opened >= std::chrono::seconds(configuration.maxAge));
+      }
+
+      // Writes all queued lines, returns whether there were any. Lines
+      // which cannot be written, e.g. as file could not be opened, are dropped.
+      bool drain(const Configuration & configuration) {
+
+        bool any = false;
+        bool triedOpen = false;
+
+        while(const Slot * slot = ring.front()) {
+
+          // Open is tried at most once per drain while failing
+          if(_openPending && !triedOpen) {
+            open(configuration.path, std::ios::trunc);
+            triedOpen = true;
+          }
+
+          if(_file.is_open() && rotationDue(configuration, slot->time))
+            rotate(configuration);
+
+          if(writeLine(*slot))
+            written++;
+          else
+            dropped++;
+
+          ring.pop();
+
+          any = true;
+        }
+
+        if(any && _file.is_open())
+          _file.flush();
+
+        return any;
+      }
+
+      bool writeLine(const Slot & slot) {
+
+        if(!_file.is_open())
+          return false;
+
+        format(slot);
+
+        _file.write(_line.data(), _line.size());
+
+        if(!_file) {
+          _file.clear();
+          return false;
+        }
+
+        _fileSize += _line.size();
+
+        return true;
+      }
+
+      // 2026-10-17T12:00:00.000Z INFO message
+      void format(const Slot & slot) {
+
+        auto sinceEpoch = slot.time.time_since_epoch();
+        std::time_t seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch).count();
+        long milliseconds = (long)(std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count() % 1000);
+
+        std::tm utc;
+
+      #ifdef _WIN32
+        gmtime_s(&utc, &seconds);
+      #else
+        gmtime_r(&seconds, &utc);
+      #endif
+
+        char prefix[64];
+        std::size_t n = std::strftime(prefix, sizeof(prefix), "%Y-%m-%dT%H:%M:%S", &utc);
+        n += std::snprintf(prefix + n, sizeof(prefix) - n, ".%03ldZ %s ", milliseconds, LevelNames[(int)slot.level]);
+
+        _line.assign(prefix, n);
+        _line.append(slot.data, slot.size);
+        _line.push_back('\n');
+      }
+
+      std::mutex _mutex;
+      std::condition_variable _wakeup;
+      std::thread _thread;
+
+      // Guarded by _mutex
+      Configuration _configuration;
+      bool _reopen;
+      bool _stopping;
+
+      // Only touched by writer thread
+      bool _openPending;
+      std::ofstream _file;
+      uint64_t _fileSize;
+      std::chrono::system_clock::time_point _opened;
+      std::string _line;
+    };
+
+    /**
+     * Stream buffer for std::clog which queues every complete line at level Info.
+     * Partial lines are kept per thread, so threads logging concurrently
+     * do not interleave within a line.
+     */
+    class LineStreamBuf : public std::streambuf {
+
+    protected:
+
+      int_type overflow(int_type c) {
+
+        if(!traits_type::eq_int_type(c, traits_type::eof())) {
+          char ch = traits_type::to_char_type(c);
+          append(&ch, 1);
+        }
+
+        return traits_type::not_eof(c);
+      }
+
+      std::streamsize xsputn(const char * s, std::streamsize n) {
+        append(s, (std::size_t)n);
+        return n;
+      }
+
+    private:
+
+      static void append(const char * s, std::size_t n) {
+
+        thread_local std::string line;
+
+        while(n > 0) {
+
+          const char * end = static_cast<const char *>(std::memchr(s, '\n', n));
+
+          if(!end) {
+            line.append(s, n);
+            return;
+          }
+
+          line.append(s, end - s);
+          write(Level::Info, line.data(), line.size());
+          line.clear();
+
+          n -= (end - s) + 1;
+          s = end + 1;
+        }
+      }
+    };
+
+    std::atomic<int> level(static_cast<int>(Level::Info));
+
+    struct Logger {
+
+      Logger()
+        : previousClogBuffer(nullptr) {
+      }
+
+      Writer writer;
+      LineStreamBuf clogBuffer;
+      std::streambuf * previousClogBuffer;
+    };
+
+    Logger & logger();
+
+    // Writes everything queued at exit. Lines queued afterwards, e.g. by
+    // libtorrent threads still running, are left in the ring.
+    void flushAtExit() {
+      logger().writer.stop();
+    }
+
+    // Never destroyed, since threads may still be logging during and after
+    // static destruction, and std::clog may still point at its buffer
+    Logger & logger() {
+
+      static Logger * l = []() {
+        std::atexit(flushAtExit);
+        return new Logger();
+      }();
+
+      return *l;
+    }
+
+    NAN_METHOD(SetLogLevel) {
+
+      ARGUMENTS_REQUIRE_NUMBER(0, value)
+
+      if(value < (double)Level::Trace || value > (double)Level::Off)
+        return Nan::ThrowRangeError("Argument 0 must be a LogLevel");
+
+      level.store((int)value, std::memory_order_relaxed);
+
+      RETURN_VOID
+    }
+
+    NAN_METHOD(ConfigureLog) {
+
+      if(info.Length() < 1 || !info[0]->IsObject())
+        return Nan::ThrowTypeError("Argument 0 must be an object");
+
+      v8::Local<v8::Object> o = Nan::To<v8::Object>(info[0]).ToLocalChecked();
+      Configuration configuration = logger().writer.configuration();
+
+      v8::Local<v8::Value> path = Nan::Get(o, Nan::New("path").ToLocalChecked()).ToLocalChecked();
+      v8::Local<v8::Value> maxSize = Nan::Get(o, Nan::New("maxSize").ToLocalChecked()).ToLocalChecked();
+      v8::Local<v8::Value> maxAge = Nan::Get(o, Nan::New("maxAge").ToLocalChecked()).ToLocalChecked();
+      v8::Local<v8::Value> maxFiles = Nan::Get(o, Nan::New("maxFiles").ToLocalChecked()).ToLocalChecked();
+
+      if(path->IsString())
+        configuration.path = *Nan::Utf8String(path);
+
+      if(maxSize->IsNumber())
+        configuration.maxSize = (uint64_t)std::max(0.0, Nan::To<double>(maxSize).FromJust());
+
+      if(maxAge->IsNumber())
+        configuration.maxAge = (uint64_t)std::max(0.0, Nan::To<double>(maxAge).FromJust());
+
+      if(maxFiles->IsNumber())
+        configuration.maxFiles = (uint32_t)std::max(0.0, Nan::To<double>(maxFiles).FromJust());
+
+      logger().writer.configure(configuration);
+
+      RETURN_VOID
+    }
+
+    NAN_METHOD(WriteLog) {
+
+      ARGUMENTS_REQUIRE_NUMBER(0, value)
+
+      if(info.Length() < 2)
+        return Nan::ThrowTypeError("Argument 1 must be a message");
+
+      Level l = static_cast<Level>(std::min(std::max((int)value, (int)Level::Trace), (int)Level::Error));
+
+      if(enabled(l)) {
+        Nan::Utf8String message(info[1]);
+        write(l, *message, message.length());
+      }
+
+      RETURN_VOID
+    }
+
+    NAN_METHOD(LogStats) {
+
+      const Writer & writer = logger().writer;
+      v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+      SET_NUMBER(o, "written", (double)writer.written.load());
+      SET_NUMBER(o, "dropped", (double)writer.dropped.load());
+      SET_NUMBER(o, "truncated", (double)writer.truncated.load());
+      SET_NUMBER(o, "rotations", (double)writer.rotations.load());
+
+      RETURN(o)
+    }
+
+  }
+
+  NAN_MODULE_INIT(Init) {
+
+    v8::Local<v8::Object> levels = Nan::New<v8::Object>();
+
+    SET_NUMBER(levels, "Trace", (int)Level::Trace);
+    SET_NUMBER(levels, "Debug", (int)Level::Debug);
+    SET_NUMBER(levels, "Info", (int)Level::Info);
+    SET_NUMBER(levels, "Warning", (int)Level::Warning);
+    SET_NUMBER(levels, "Error", (int)Level::Error);
+    SET_NUMBER(levels, "Off", (int)Level::Off);
+
+    SET_VAL(target, "LogLevel", levels);
+
+    Nan::Set(target, Nan::New("setLogLevel").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(SetLogLevel)->GetFunction());
+    Nan::Set(target, Nan::New("configureLog").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(ConfigureLog)->GetFunction());
+    Nan::Set(target, Nan::New("writeLog").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(WriteLog)->GetFunction());
+    Nan::Set(target, Nan::New("logStats").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(LogStats)->GetFunction());
+  }
+
+  void start(const std::string & path) {
+
+    Logger & l = logger();
+
+    Configuration configuration;
+    configuration.path = path;
+
+    l.writer.start(configuration);
+
+    if(!l.previousClogBuffer)
+      l.previousClogBuffer = std::clog.rdbuf(&l.clogBuffer);
+  }
+
+  bool enabled(Level l) {
+    return (int)l >= level.load(std::memory_order_relaxed);
+  }
+
+  void write(Level l, const char * data, std::size_t size) {
+
+    if(!enabled(l) || l == Level::Off)
+      return;
+
+    Writer & writer = logger().writer;
+    bool truncated;
+
+    if(!writer.ring.push(l, data, size, truncated))
+      writer.dropped++;
+    else if(truncated)
+      writer.truncated++;
+  }
+
+}
+}
+}
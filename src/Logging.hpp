@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_LOGGING_HPP
+#define JOYSTREAM_NODE_LOGGING_HPP
+
+#include <nan.h>
+
+#include <cstddef>
+#include <string>
+
+namespace joystream {
+namespace node {
+namespace logging {
+
+  /*
+   * Asynchronous log file.
+   *
+   * Lines are put in a bounded lock-free ring by whatever thread logs them,
+   * and written to file by a background thread, so logging never waits on
+   * file I/O. When the ring is full lines are dropped and counted, rather
+   * than blocking the logging thread. The file is rotated when it grows
+   * beyond a size, or gets older than an age, keeping a number of old files
+   * as <path>.1, <path>.2, ...
+   *
+   * std::clog, which is what the extension logs to, is redirected to the
+   * ring at level Info.
+   */
+
+  enum class Level { Trace = 0, Debug = 1, Info = 2, Warning = 3, Error = 4, Off = 5 };
+
+  // Exports
+  // - "LogLevel" (Object) of Level values
+  // - "setLogLevel" (level), lines below level are discarded where logged
+  // - "configureLog" ({path, maxSize, maxAge, maxFiles}), all optional, where maxSize
+  //   is in bytes and maxAge in seconds, 0 meaning no limit
+  // - "writeLog" (level, message)
+  // - "logStats" () returns {written, dropped, truncated, rotations}, where dropped counts
+  //   lines dropped as ring was full, or as file could not be opened or written
+  NAN_MODULE_INIT(Init);
+
+  /* @brief Starts writer thread on file at path, and redirects std::clog to log.
+   * The file is only created once a line is written, so a path configured before
+   * then is used instead. Everything queued is written at exit, std::clog stays redirected.
+   *
+   * @param path log file, truncated
+   */
+  void start(const std::string & path);
+
+  /* @brief Whether lines at level are kept, cheap enough to
+   * guard formatting of a line.
+   */
+  bool enabled(Level level);
+
+  /* @brief Queues line for writing, never blocks. Does nothing if level
+   * is not enabled, and counts line as dropped if ring is full.
+   *
+   * @param level of line
+   * @param data line, without line ending, truncated if very long
+   * @param size of line
+   */
+  void write(Level level, const char * data, std::size_t size);
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_LOGGING_HPP
@@ -0,0 +1,238 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "Metrics.hpp"
+#include "libtorrent-node/utils.hpp"
+
+#include <deque>
+#include <limits>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace joystream {
+namespace node {
+namespace metrics {
+
+  namespace {
+
+    // count, sum, min, max, buckets
+    const uint32_t HistogramStride = 4 + Histogram::NumberOfBuckets;
+
+    struct Registry {
+
+      // Deques, as references to metrics are held
+      std::deque<Counter> counters;
+      std::vector<std::string> counterNames;
+
+      std::deque<Histogram> histograms;
+      std::vector<std::string> histogramNames;
+    };
+
+    // Constructed on first use, as metrics are registered by static initializers of other files
+    Registry & registry() {
+      static Registry r;
+      return r;
+    }
+
+    // Index of most significant bit set, value must not be 0
+    uint32_t mostSignificantBit(uint64_t value) {
+
+    #ifdef _MSC_VER
+      unsigned long index;
+      _BitScanReverse64(&index, value);
+      return index;
+    #else
+      return 63 - __builtin_clzll(value);
+    #endif
+    }
+
+    v8::Local<v8::Float64Array> newFloat64Array(std::size_t length) {
+      v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), length * sizeof(double));
+      return v8::Float64Array::New(buffer, 0, length);
+    }
+
+    // Array of snapshot to refill, or new array if there is none of given length
+    v8::Local<v8::Float64Array> snapshotArray(const v8::Local<v8::Value> & snapshot, const char * name, std::size_t length) {
+
+      if(snapshot->IsObject()) {
+
+        v8::Local<v8::Value> v = Nan::Get(Nan::To<v8::Object>(snapshot).ToLocalChecked(), Nan::New(name).ToLocalChecked()).ToLocalChecked();
+
+        if(v->IsFloat64Array() && v8::Local<v8::Float64Array>::Cast(v)->Length() == length)
+          return v8::Local<v8::Float64Array>::Cast(v);
+      }
+
+      return newFloat64Array(length);
+    }
+
+    v8::Local<v8::Array> encodeNames(const std::vector<std::string> & names) {
+
+      v8::Local<v8::Array> a = Nan::New<v8::Array>(names.size());
+
+      for(uint32_t i = 0;i < names.size();i++)
+        Nan::Set(a, i, Nan::New(names[i]).ToLocalChecked());
+
+      return a;
+    }
+
+    NAN_METHOD(Snapshot) {
+
+      const std::deque<Counter> & counters = registry().counters;
+      const std::deque<Histogram> & histograms = registry().histograms;
+
+      v8::Local<v8::Value> previous = info.Length() > 0 ? info[0] : v8::Local<v8::Value>(Nan::Undefined());
+
+      v8::Local<v8::Float64Array> countersArray = snapshotArray(previous, "counters", counters.size());
+      v8::Local<v8::Float64Array> histogramsArray = snapshotArray(previous, "histograms", histograms.size() * HistogramStride);
+
+      {
+        Nan::TypedArrayContents<double> values(countersArray);
+
+        for(std::size_t i = 0;i < counters.size();i++)
+          (*values)[i] = (double)counters[i].value();
+      }
+
+      {
+        Nan::TypedArrayContents<double> values(histogramsArray);
+
+        for(std::size_t i = 0;i < histograms.size();i++) {
+
+          const Histogram & h = histograms[i];
+          double * v = *values + i * HistogramStride;
+
+          v[0] = (double)h.count();
+          v[1] = (double)h.sum();
+          v[2] = h.count() > 0 ? (double)h.min() : 0;
+          v[3] = (double)h.max();
+
+          for(uint32_t b = 0;b < Histogram::NumberOfBuckets;b++)
+            v[4 + b] = (double)h.bucketCount(b);
+        }
+      }
+
+      v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+      SET_VAL(o, "counters", countersArray);
+      SET_VAL(o, "histograms", histogramsArray);
+
+      RETURN(o)
+    }
+
+    NAN_METHOD(Layout) {
+
+      v8::Local<v8::Float64Array> bounds = newFloat64Array(Histogram::NumberOfBuckets);
+
+      {
+        Nan::TypedArrayContents<double> values(bounds);
+
+        for(uint32_t b = 0;b < Histogram::NumberOfBuckets;b++)
+          (*values)[b] = (double)Histogram::lowerBound(b);
+      }
+
+      v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+      SET_VAL(o, "counters", encodeNames(registry().counterNames));
+      SET_VAL(o, "histograms", encodeNames(registry().histogramNames));
+      SET_NUMBER(o, "stride", HistogramStride);
+      SET_VAL(o, "bucketLowerBounds", bounds);
+
+      RETURN(o)
+    }
+
+  }
+
+  Counter::Counter()
+    : _value(0) {
+  }
+
+  Histogram::Histogram()
+    : _count(0)
+    , _sum(0)
+    , _min(std::numeric_limits<uint64_t>::max())
+    , _max(0) {
+
+    for(auto & b : _buckets)
+      b.store(0, std::memory_order_relaxed);
+  }
+
+  void Histogram::record(uint64_t value) {
+
+    _buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current = _min.load(std::memory_order_relaxed);
+    while(value < current && !_min.compare_exchange_weak(current, value, std::memory_order_relaxed));
+
+    current = _max.load(std::memory_order_relaxed);
+    while(value > current && !_max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+  }
+
+  uint64_t Histogram::lowerBound(uint32_t bucket) {
+
+    if(bucket < SubBuckets)
+      return bucket;
+
+    uint32_t row = bucket / SubBuckets;
+
+    return (uint64_t)(SubBuckets + bucket % SubBuckets) << (row - 1);
+  }
+
+  uint32_t Histogram::bucket(uint64_t value) {
+
+    if(value < SubBuckets)
+      return (uint32_t)value;
+
+    uint32_t exponent = mostSignificantBit(value);
+
+    if(exponent > MaxExponent)
+      return NumberOfBuckets - 1;
+
+    return (exponent - SubBucketBits + 1) * SubBuckets + (uint32_t)((value >> (exponent - SubBucketBits)) & (SubBuckets - 1));
+  }
+
+  Counter & counter(const std::string & name) {
+
+    Registry & r = registry();
+
+    for(std::size_t i = 0;i < r.counterNames.size();i++)
+      if(r.counterNames[i] == name)
+        return r.counters[i];
+
+    r.counters.emplace_back();
+    r.counterNames.push_back(name);
+
+    return r.counters.back();
+  }
+
+  Histogram & histogram(const std::string & name) {
+
+    Registry & r = registry();
+
+    for(std::size_t i = 0;i < r.histogramNames.size();i++)
+      if(r.histogramNames[i] == name)
+        return r.histograms[i];
+
+    r.histograms.emplace_back();
+    r.histogramNames.push_back(name);
+
+    return r.histograms.back();
+  }
+
+  NAN_MODULE_INIT(Init) {
+
+    Nan::Set(target, Nan::New("metrics").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(Snapshot)->GetFunction());
+    Nan::Set(target, Nan::New("metricsLayout").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(Layout)->GetFunction());
+  }
+
+}
+}
+}
@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_METRICS_HPP
+#define JOYSTREAM_NODE_METRICS_HPP
+
+#include <nan.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace joystream {
+namespace node {
+namespace metrics {
+
+  /*
+   * Registry of counters and histograms, updated with relaxed atomics so
+   * any thread may record, and read by javascript as a snapshot of two
+   * Float64Arrays, with names and bucket bounds given once by the layout.
+   *
+   * Metrics are registered when modules are initialized, so the layout never
+   * changes after the addon is loaded.
+   */
+
+  class Counter {
+
+  public:
+
+    Counter();
+
+    void add(uint64_t n = 1) { _value.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+  private:
+
+    std::atomic<uint64_t> _value;
+  };
+
+  /**
+   * @brief Histogram with log-linear buckets, in the manner of HdrHistogram:
+   * values below 8 have a bucket each, and every power of two above is split
+   * in 8 buckets, so a value is known to within 12.5%. Values from 2^36
+   * (about 69 seconds in nanoseconds) are counted in the last bucket.
+   */
+  class Histogram {
+
+  public:
+
+    static const uint32_t SubBucketBits = 3;
+    static const uint32_t SubBuckets = 1 << SubBucketBits;
+    static const uint32_t MaxExponent = 35;
+    static const uint32_t NumberOfBuckets = (MaxExponent - SubBucketBits + 2) * SubBuckets;
+
+    Histogram();
+
+    void record(uint64_t value);
+
+    // Smallest value counted in bucket
+    static uint64_t lowerBound(uint32_t bucket);
+
+    static uint32_t bucket(uint64_t value);
+
+    uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return _sum.load(std::memory_order_relaxed); }
+    uint64_t min() const { return _min.load(std::memory_order_relaxed); }
+    uint64_t max() const { return _max.load(std::memory_order_relaxed); }
+    uint64_t bucketCount(uint32_t bucket) const { return _buckets[bucket].load(std::memory_order_relaxed); }
+
+  private:
+
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum;
+    std::atomic<uint64_t> _min;
+    std::atomic<uint64_t> _max;
+    std::atomic<uint64_t> _buckets[NumberOfBuckets];
+  };
+
+  /**
+   * @brief Records nanoseconds from construction to destruction in histogram,
+   * also when scope is left by an exception.
+   */
+  class Timer {
+
+  public:
+
+    explicit Timer(Histogram & histogram)
+      : _histogram(histogram)
+      , _start(std::chrono::steady_clock::now()) {
+    }
+
+    ~Timer() {
+      _histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count());
+    }
+
+  private:
+
+    Histogram & _histogram;
+    std::chrono::steady_clock::time_point _start;
+  };
+
+  /* @brief Registers counter, or returns counter already registered with name.
+   * Only called while addon is loaded, by static initializers or module Init.
+   *
+   * @param name unique name, such as "requests_submitted"
+   * @return counter, valid for lifetime of addon
+   */
+  Counter & counter(const std::string & name);
+
+  /* @brief Registers histogram, or returns histogram already registered with name.
+   * Only called while addon is loaded, by static initializers or module Init.
+   *
+   * @param name unique name, suffixed by unit of values, such as "_ns"
+   * @return histogram, valid for lifetime of addon
+   */
+  Histogram & histogram(const std::string & name);
+
+  // Exports
+  // - "metrics" ([snapshot]) returns {counters, histograms} snapshot of Float64Arrays,
+  //   where histogram i occupies [i * stride, (i + 1) * stride) of histograms as
+  //   count, sum, min, max and then count of each bucket. A previous snapshot may
+  //   be passed to be refilled rather than allocating a new one.
+  // - "metricsLayout" () returns {counters, histograms, stride, bucketLowerBounds},
+  //   with names in the order of the snapshot
+  NAN_MODULE_INIT(Init);
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_METRICS_HPP
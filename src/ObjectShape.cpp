@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "ObjectShape.hpp"
+
+#include <cassert>
+
+namespace joystream {
+namespace node {
+
+ObjectShape::ObjectShape(std::initializer_list<const char *> keys, std::size_t optional)
+  : _numberOfKeys(keys.size())
+  , _keys(new v8::Eternal<v8::String>[keys.size()]) {
+
+  v8::Isolate * isolate = v8::Isolate::GetCurrent();
+  v8::Local<v8::ObjectTemplate> tpl = Nan::New<v8::ObjectTemplate>();
+
+  std::size_t i = 0;
+
+  for(const char * key : keys) {
+
+    v8::Local<v8::String> s = v8::String::NewFromUtf8(isolate, key, v8::NewStringType::kInternalized).ToLocalChecked();
+
+    _keys[i].Set(isolate, s);
+
+    if(i < _numberOfKeys - optional)
+      tpl->Set(s, Nan::Undefined());
+
+    i++;
+  }
+
+  _template.Set(isolate, tpl);
+}
+
+v8::Local<v8::Object> ObjectShape::NewInstance() const {
+  return Nan::NewInstance(_template.Get(v8::Isolate::GetCurrent())).ToLocalChecked();
+}
+
+void ObjectShape::Set(v8::Local<v8::Object> o, std::size_t key, v8::Local<v8::Value> value) const {
+  Nan::Set(o, Key(key), value);
+}
+
+v8::Local<v8::String> ObjectShape::Key(std::size_t key) const {
+  assert(key < _numberOfKeys);
+  return _keys[key].Get(v8::Isolate::GetCurrent());
+}
+
+}
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_OBJECT_SHAPE_HPP
+#define JOYSTREAM_NODE_OBJECT_SHAPE_HPP
+
+#include <nan.h>
+
+#include <initializer_list>
+#include <memory>
+
+namespace joystream {
+namespace node {
+
+/**
+ * @brief Fixed set of keys for objects created by an encoder. Keys are
+ * internalized once, and objects are instantiated from a template which
+ * already has every required key, so all objects share one hidden class,
+ * rather than being built up one key at a time from a fresh string.
+ *
+ * Must be created on the node thread, typically as a function local static
+ * in the encoder which uses it. There is only ever one isolate per addon.
+ */
+class ObjectShape {
+
+public:
+
+  /**
+   * @brief Creates shape with given keys, where the last `optional` keys
+   * are not part of the template, and are only present when set.
+   * @param keys all keys, required first
+   * @param optional number of optional keys
+   */
+  ObjectShape(std::initializer_list<const char *> keys, std::size_t optional = 0);
+
+  /**
+   * @brief Creates object with every required key set to undefined
+   * @return {v8::Local<v8::Object>}
+   */
+  v8::Local<v8::Object> NewInstance() const;
+
+  /**
+   * @brief Sets key of object
+   * @param o object, created with NewInstance
+   * @param key index of key in keys the shape was created with
+   * @param value value of key
+   */
+  void Set(v8::Local<v8::Object> o, std::size_t key, v8::Local<v8::Value> value) const;
+
+  /**
+   * @brief Internalized key
+   * @param key index of key in keys the shape was created with
+   * @return {v8::Local<v8::String>}
+   */
+  v8::Local<v8::String> Key(std::size_t key) const;
+
+private:
+
+  std::size_t _numberOfKeys;
+
+  std::unique_ptr<v8::Eternal<v8::String>[]> _keys;
+
+  v8::Eternal<v8::ObjectTemplate> _template;
+};
+
+}
+}
+
+#endif // JOYSTREAM_NODE_OBJECT_SHAPE_HPP
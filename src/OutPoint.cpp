@@ -1,6 +1,7 @@
 #include <common/typesafeOutPoint.hpp>
 #include "OutPoint.hpp"
 #include "TransactionId.hpp"
+#include "ObjectShape.hpp"
 #include "libtorrent-node/utils.hpp"
 
 namespace joystream {
@@ -11,12 +12,16 @@ namespace outpoint {
 #define INDEX_KEY "index"
 
 
+enum Key { Txid, Index };
+
 v8::Local<v8::Object> encode(const Coin::typesafeOutPoint &op) {
+    static const ObjectShape shape({TXID_KEY, INDEX_KEY});
+
     auto txid = transaction_id::encode(op.transactionId());
     auto index = op.index();
-    auto obj = Nan::New<v8::Object>();
-    SET_VAL(obj, TXID_KEY, txid);
-    SET_INT32(obj, INDEX_KEY, index);
+    auto obj = shape.NewInstance();
+    shape.Set(obj, Txid, txid);
+    shape.Set(obj, Index, Nan::New<v8::Int32>(index));
     return obj;
 }
 
@@ -0,0 +1,160 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "PaymentAlertBatch.hpp"
+#include "libtorrent-node/utils.hpp"
+#include "Hashes.hpp"
+#include "AlertTimestamp.hpp"
+
+#include <extension/extension.hpp>
+
+#include <cstring>
+
+namespace joystream {
+namespace node {
+namespace payment_alert_batch {
+
+  namespace {
+
+    uint32_t indexOf(const libtorrent::sha1_hash & h, std::vector<libtorrent::sha1_hash> & list, std::map<libtorrent::sha1_hash, uint32_t> & indexes) {
+
+      auto it = indexes.find(h);
+
+      if(it != indexes.end())
+        return it->second;
+
+      uint32_t i = (uint32_t)list.size();
+
+      list.push_back(h);
+      indexes.insert(std::make_pair(h, i));
+
+      return i;
+    }
+
+    template<class T>
+    void copyColumn(const std::vector<T> & column, char * data, std::size_t & offset) {
+      std::memcpy(data + offset, column.data(), column.size() * sizeof(T));
+      offset += column.size() * sizeof(T);
+    }
+
+    // Float64 columns come first, so every view is aligned
+    v8::Local<v8::Object> encode(const Columns & c) {
+
+      const std::size_t n = c.size();
+      const std::size_t byteLength = n * (4 * sizeof(double) + 2 * sizeof(uint32_t) + sizeof(int32_t));
+
+      v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), byteLength);
+      char * data = static_cast<char *>(buffer->GetContents().Data());
+
+      v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+      SET_NUMBER(o, "length", n);
+      SET_VAL(o, "buffer", buffer);
+
+      std::size_t offset = 0;
+
+      SET_VAL(o, "timestamp", v8::Float64Array::New(buffer, offset, n));
+      copyColumn(c.timestamp, data, offset);
+
+      SET_VAL(o, "paymentIncrement", v8::Float64Array::New(buffer, offset, n));
+      copyColumn(c.paymentIncrement, data, offset);
+
+      SET_VAL(o, "totalAmountPaid", v8::Float64Array::New(buffer, offset, n));
+      copyColumn(c.totalAmountPaid, data, offset);
+
+      SET_VAL(o, "total", v8::Float64Array::New(buffer, offset, n));
+      copyColumn(c.total, data, offset);
+
+      SET_VAL(o, "torrentIndex", v8::Uint32Array::New(buffer, offset, n));
+      copyColumn(c.torrentIndex, data, offset);
+
+      SET_VAL(o, "peerIndex", v8::Uint32Array::New(buffer, offset, n));
+      copyColumn(c.peerIndex, data, offset);
+
+      SET_VAL(o, "pieceIndex", v8::Int32Array::New(buffer, offset, n));
+      copyColumn(c.pieceIndex, data, offset);
+
+      return o;
+    }
+
+  }
+
+  void Columns::clear() {
+    timestamp.clear();
+    paymentIncrement.clear();
+    totalAmountPaid.clear();
+    total.clear();
+    torrentIndex.clear();
+    peerIndex.clear();
+    pieceIndex.clear();
+  }
+
+  void Columns::push(const libtorrent::alert * a, uint32_t torrent, uint32_t peer, int32_t piece, double increment, double amount, double n) {
+    timestamp.push_back(alert_timestamp::encode(a));
+    paymentIncrement.push_back(increment);
+    totalAmountPaid.push_back(amount);
+    total.push_back(n);
+    torrentIndex.push_back(torrent);
+    peerIndex.push_back(peer);
+    pieceIndex.push_back(piece);
+  }
+
+  void Batch::collect(const libtorrent::alert * a) {
+
+    if(auto p = libtorrent::alert_cast<extension::alert::SentPayment>(a))
+      _sentPayment.push(a, torrentIndex(p), peerIndex(p), p->pieceIndex, p->paymentIncrement, p->totalAmountPaid, p->totalNumberOfPayments);
+    else if(auto p = libtorrent::alert_cast<extension::alert::ValidPaymentReceived>(a))
+      _validPaymentReceived.push(a, torrentIndex(p), peerIndex(p), -1, p->paymentIncrement, p->totalAmountPaid, p->totalNumberOfPayments);
+    else if(auto p = libtorrent::alert_cast<extension::alert::SendingPieceToBuyer>(a))
+      _sendingPieceToBuyer.push(a, torrentIndex(p), peerIndex(p), p->pieceIndex, 0, 0, p->totalNumberOfPiecesSent);
+    else if(auto p = libtorrent::alert_cast<extension::alert::ValidPieceArrived>(a))
+      _validPieceArrived.push(a, torrentIndex(p), peerIndex(p), p->pieceIndex, 0, 0, 0);
+  }
+
+  uint32_t Batch::torrentIndex(const libtorrent::peer_alert * p) {
+    return indexOf(p->handle.info_hash(), _torrents, _torrentIndexes);
+  }
+
+  uint32_t Batch::peerIndex(const libtorrent::peer_alert * p) {
+    return indexOf(p->pid, _peers, _peerIndexes);
+  }
+
+  v8::Local<v8::Value> Batch::take() {
+
+    if(_sentPayment.size() + _validPaymentReceived.size() + _sendingPieceToBuyer.size() + _validPieceArrived.size() == 0)
+      return Nan::Undefined();
+
+    v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+    v8::Local<v8::Array> torrentList = Nan::New<v8::Array>();
+    for(auto & h : _torrents)
+      torrentList->Set(torrentList->Length(), hashes::encodeInfoHash(h));
+
+    v8::Local<v8::Array> peerList = Nan::New<v8::Array>();
+    for(auto & pid : _peers)
+      peerList->Set(peerList->Length(), hashes::encodePeerId(pid));
+
+    SET_VAL(o, "torrents", torrentList);
+    SET_VAL(o, "peers", peerList);
+
+    #define SET_COLUMNS(name, columns) if(columns.size() > 0) { SET_VAL(o, #name, encode(columns)); } columns.clear();
+
+    SET_COLUMNS(SentPayment, _sentPayment)
+    SET_COLUMNS(ValidPaymentReceived, _validPaymentReceived)
+    SET_COLUMNS(SendingPieceToBuyer, _sendingPieceToBuyer)
+    SET_COLUMNS(ValidPieceArrived, _validPieceArrived)
+
+    _torrents.clear();
+    _torrentIndexes.clear();
+    _peers.clear();
+    _peerIndexes.clear();
+
+    return o;
+  }
+
+}
+}
+}
@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_PAYMENT_ALERT_BATCH_HPP
+#define JOYSTREAM_NODE_PAYMENT_ALERT_BATCH_HPP
+
+#include <nan.h>
+
+#include <libtorrent/sha1_hash.hpp>
+
+#include <map>
+#include <vector>
+
+namespace libtorrent {
+  class alert;
+  struct peer_alert;
+}
+
+namespace joystream {
+namespace node {
+namespace payment_alert_batch {
+
+  /*
+   * Columnar accumulation of the high volume payment alerts
+   * SentPayment, ValidPaymentReceived, SendingPieceToBuyer and ValidPieceArrived,
+   * as an alternative to encoding one object per alert.
+   *
+   * Alerts are collected on the node thread while alerts are popped,
+   * and the batch is then taken with `take`.
+   */
+
+  // Columns of alerts of one type
+  struct Columns {
+
+    std::size_t size() const { return torrentIndex.size(); }
+
+    void clear();
+
+    void push(const libtorrent::alert * a, uint32_t torrent, uint32_t peer, int32_t piece, double increment, double amount, double n);
+
+    std::vector<double> timestamp;
+    std::vector<double> paymentIncrement;
+    std::vector<double> totalAmountPaid;
+    std::vector<double> total;
+    std::vector<uint32_t> torrentIndex;
+    std::vector<uint32_t> peerIndex;
+    std::vector<int32_t> pieceIndex;
+  };
+
+  class Batch {
+
+  public:
+
+    /* @brief Adds alert to batch, alert must be one of the payment alert types above.
+     *
+     * @param a alert
+     */
+    void collect(const libtorrent::alert * a);
+
+    /* @brief Creates javascript representation of all alerts collected since
+     * last call, and resets batch.
+     *
+     * @return v8::Local<v8::Value>, undefined if no alerts were collected, otherwise o where
+     *
+     * {Array} o.torrents - info hashes referred to by torrentIndex columns.
+     * {Array} o.peers - peer ids referred to by peerIndex columns.
+     * {Object} o.<AlertName> - only present when such alerts were collected, b where
+     *   {Number} b.length - number of alerts
+     *   {ArrayBuffer} b.buffer - backing store of all columns below
+     *   {Float64Array} b.timestamp - microseconds when alert was raised, see alert_timestamp
+     *   {Float64Array} b.paymentIncrement - 0 for alerts without payments
+     *   {Float64Array} b.totalAmountPaid - 0 for alerts without payments
+     *   {Float64Array} b.total - totalNumberOfPayments, or totalNumberOfPiecesSent for SendingPieceToBuyer
+     *   {Uint32Array} b.torrentIndex - index into o.torrents
+     *   {Uint32Array} b.peerIndex - index into o.peers
+     *   {Int32Array} b.pieceIndex - -1 for ValidPaymentReceived, which has no piece
+     */
+    v8::Local<v8::Value> take();
+
+  private:
+
+    uint32_t torrentIndex(const libtorrent::peer_alert * p);
+
+    uint32_t peerIndex(const libtorrent::peer_alert * p);
+
+    Columns _sentPayment, _validPaymentReceived, _sendingPieceToBuyer, _validPieceArrived;
+
+    std::vector<libtorrent::sha1_hash> _torrents;
+    std::map<libtorrent::sha1_hash, uint32_t> _torrentIndexes;
+
+    std::vector<libtorrent::peer_id> _peers;
+    std::map<libtorrent::peer_id, uint32_t> _peerIndexes;
+  };
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_PAYMENT_ALERT_BATCH_HPP
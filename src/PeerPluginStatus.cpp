@@ -8,9 +8,11 @@
 #include "PeerPluginStatus.hpp"
 #include "libtorrent-node/utils.hpp"
 #include "libtorrent-node/endpoint.hpp"
-#include "libtorrent-node/peer_id.hpp"
+#include "Hashes.hpp"
 #include "BEPSupportStatus.hpp"
 #include "Connection.hpp"
+#include "ObjectShape.hpp"
+#include "Tracing.hpp"
 
 namespace joystream {
 namespace node {
@@ -21,17 +23,24 @@ NAN_MODULE_INIT(Init) {
   connection::Init(target);
 }
 
+enum Key { Pid, EndPoint, PeerBEP10SupportStatus, PeerBitSwaprBEPSupportStatus, Connection };
+
 v8::Local<v8::Object> encode(const extension::status::PeerPlugin & s) {
 
-  v8::Local<v8::Object> o = Nan::New<v8::Object>();
+  tracing::Span span("peer_plugin_status::encode", "status");
+
+  // connection is only present when there is one
+  static const ObjectShape shape({"pid", "endPoint", "peerBEP10SupportStatus", "peerBitSwaprBEPSupportStatus", "connection"}, 1);
+
+  v8::Local<v8::Object> o = shape.NewInstance();
 
-  SET_VAL(o, "pid", libtorrent::node::peer_id::encode(s.peerId));
-  SET_VAL(o, "endPoint", libtorrent::node::endpoint::encode(s.endPoint));
-  SET_VAL(o, "peerBEP10SupportStatus", bep_support_status::encode(s.peerBEP10SupportStatus));
-  SET_VAL(o, "peerBitSwaprBEPSupportStatus", bep_support_status::encode(s.peerBitSwaprBEPSupportStatus));
+  shape.Set(o, Pid, hashes::encodePeerId(s.peerId));
+  shape.Set(o, EndPoint, libtorrent::node::endpoint::encode(s.endPoint));
+  shape.Set(o, PeerBEP10SupportStatus, bep_support_status::encode(s.peerBEP10SupportStatus));
+  shape.Set(o, PeerBitSwaprBEPSupportStatus, bep_support_status::encode(s.peerBitSwaprBEPSupportStatus));
 
   if(s.connection)
-    SET_VAL(o, "connection", connection::encode(s.connection.get()));
+    shape.Set(o, Connection, connection::encode(s.connection.get()));
 
   return o;
 }
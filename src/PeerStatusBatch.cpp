@@ -0,0 +1,50 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "PeerStatusBatch.hpp"
+#include "PeerPluginStatus.hpp"
+#include "libtorrent-node/utils.hpp"
+#include "Hashes.hpp"
+
+namespace joystream {
+namespace node {
+namespace peer_status_batch {
+
+  void Batch::collect(const libtorrent::alert * a) {
+
+    if(auto p = libtorrent::alert_cast<extension::alert::PeerPluginStatusUpdateAlert>(a))
+      _batch[p->handle.info_hash()] = p->statuses;
+  }
+
+  v8::Local<v8::Value> Batch::take() {
+
+    if(_batch.empty())
+      return Nan::Undefined();
+
+    v8::Local<v8::Array> updates = Nan::New<v8::Array>();
+
+    for(auto & m : _batch) {
+
+      v8::Local<v8::Object> u = Nan::New<v8::Object>();
+      v8::Local<v8::Array> statuses = Nan::New<v8::Array>();
+
+      for(auto & s : m.second)
+        statuses->Set(statuses->Length(), peer_plugin_status::encode(s.second));
+
+      SET_VAL(u, "infoHash", hashes::encodeInfoHash(m.first));
+      SET_VAL(u, "statuses", statuses);
+
+      updates->Set(updates->Length(), u);
+    }
+
+    _batch.clear();
+
+    return updates;
+  }
+
+}
+}
+}
@@ -0,0 +1,58 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_PEER_STATUS_BATCH_HPP
+#define JOYSTREAM_NODE_PEER_STATUS_BATCH_HPP
+
+#include <nan.h>
+
+#include <extension/extension.hpp>
+
+#include <map>
+
+namespace joystream {
+namespace node {
+namespace peer_status_batch {
+
+  /*
+   * Merges the PeerPluginStatusUpdateAlert of every torrent, which are
+   * posted one per torrent, into a single delivery. Only the most recent
+   * statuses of a torrent are kept.
+   */
+
+  class Batch {
+
+  public:
+
+    /* @brief Adds statuses of alert to batch.
+     *
+     * @param a alert, must be PeerPluginStatusUpdateAlert
+     */
+    void collect(const libtorrent::alert * a);
+
+    /* @brief Creates javascript representation of all statuses collected
+     * since last call, and resets batch.
+     *
+     * @return v8::Local<v8::Value>, undefined if nothing was collected, otherwise an array with
+     * an object u for each torrent, where
+     *
+     * {String} u.infoHash - torrent
+     * {Array} u.statuses - {see peer_plugin_status::encode} for each peer
+     */
+    v8::Local<v8::Value> take();
+
+  private:
+
+    typedef decltype(extension::alert::PeerPluginStatusUpdateAlert::statuses) Statuses;
+
+    std::map<libtorrent::sha1_hash, Statuses> _batch;
+  };
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_PEER_STATUS_BATCH_HPP
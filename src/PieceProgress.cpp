@@ -0,0 +1,90 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "PieceProgress.hpp"
+
+#include <extension/extension.hpp>
+#include <libtorrent/alert_types.hpp>
+
+namespace joystream {
+namespace node {
+namespace piece_progress {
+
+  namespace {
+
+    // Bound on each kind of piece in progress
+    const std::size_t MaxPiecesInProgress = 256;
+
+    Ended ended(Stage stage, int pieceIndex, const libtorrent::time_point & start, const libtorrent::time_point & end) {
+
+      Ended e;
+
+      e.stage = stage;
+      e.pieceIndex = pieceIndex;
+      e.start = start;
+      e.end = end;
+
+      return e;
+    }
+
+  }
+
+  boost::optional<Ended> Pieces::observe(const libtorrent::alert * a) {
+
+    boost::optional<Ended> e;
+
+    if(auto p = libtorrent::alert_cast<extension::alert::PieceRequestedByBuyer>(a)) {
+
+      if(_requested.size() < MaxPiecesInProgress)
+        _requested[p->pieceIndex] = p->timestamp();
+
+    } else if(auto p = libtorrent::alert_cast<extension::alert::SendingPieceToBuyer>(a)) {
+
+      Sent sent;
+
+      sent.pieceIndex = p->pieceIndex;
+      sent.sent = p->timestamp();
+
+      auto requested = _requested.find(p->pieceIndex);
+
+      if(requested != _requested.end()) {
+        e = ended(Stage::RequestToSend, p->pieceIndex, requested->second, p->timestamp());
+        sent.requested = requested->second;
+        _requested.erase(requested);
+      }
+
+      if(_sent.size() < MaxPiecesInProgress)
+        _sent.push_back(sent);
+
+    } else if(auto p = libtorrent::alert_cast<extension::alert::ValidPaymentReceived>(a)) {
+
+      if(!_sent.empty()) {
+        e = ended(Stage::SendToPayment, _sent.front().pieceIndex, _sent.front().sent, p->timestamp());
+        e->requested = _sent.front().requested;
+        _sent.pop_front();
+      }
+
+    } else if(auto p = libtorrent::alert_cast<extension::alert::ValidPieceArrived>(a)) {
+
+      if(_arrived.size() < MaxPiecesInProgress)
+        _arrived[p->pieceIndex] = p->timestamp();
+
+    } else if(auto p = libtorrent::alert_cast<extension::alert::SentPayment>(a)) {
+
+      auto arrived = _arrived.find(p->pieceIndex);
+
+      if(arrived != _arrived.end()) {
+        e = ended(Stage::ArrivalToPayment, p->pieceIndex, arrived->second, p->timestamp());
+        _arrived.erase(arrived);
+      }
+    }
+
+    return e;
+  }
+
+}
+}
+}
@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_PIECE_PROGRESS_HPP
+#define JOYSTREAM_NODE_PIECE_PROGRESS_HPP
+
+#include <libtorrent/time.hpp>
+
+#include <boost/optional.hpp>
+
+#include <deque>
+#include <map>
+
+namespace libtorrent {
+  class alert;
+}
+
+namespace joystream {
+namespace node {
+namespace piece_progress {
+
+  /*
+   * Stages of paid pieces of one connection, matched from alert timestamps.
+   * A session is seller or buyer on a connection, so stages are those visible
+   * on each side:
+   *
+   * Seller
+   * - RequestToSend: PieceRequestedByBuyer to SendingPieceToBuyer, reading piece from disk
+   * - SendToPayment: SendingPieceToBuyer to ValidPaymentReceived, network round trip,
+   *   and validation and signing by buyer. Payments carry no piece, so they are
+   *   matched to pieces in the order they were sent.
+   *
+   * Buyer
+   * - ArrivalToPayment: ValidPieceArrived to SentPayment for the same piece, signing payment
+   */
+
+  enum class Stage { RequestToSend = 0, SendToPayment = 1, ArrivalToPayment = 2 };
+
+  // Stage of a piece, ended by an alert
+  struct Ended {
+
+    Stage stage;
+    int pieceIndex;
+    libtorrent::time_point start;
+    libtorrent::time_point end;
+
+    // When piece was requested, for SendToPayment of a piece whose request was seen
+    boost::optional<libtorrent::time_point> requested;
+  };
+
+  /**
+   * Pieces in progress on one connection, bounded so a peer which never
+   * pays cannot grow them without limit.
+   */
+  class Pieces {
+
+  public:
+
+    /* @brief Advances piece of alert, if alert is one of the above
+     *
+     * @param a alert of this connection
+     * @return stage ended by alert, if any
+     */
+    boost::optional<Ended> observe(const libtorrent::alert * a);
+
+  private:
+
+    struct Sent {
+      int pieceIndex;
+      libtorrent::time_point sent;
+      boost::optional<libtorrent::time_point> requested;
+    };
+
+    // Seller, requested but not sent
+    std::map<int, libtorrent::time_point> _requested;
+
+    // Seller, sent but not paid, in order sent
+    std::deque<Sent> _sent;
+
+    // Buyer, arrived but not paid
+    std::map<int, libtorrent::time_point> _arrived;
+  };
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_PIECE_PROGRESS_HPP
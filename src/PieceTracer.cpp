@@ -0,0 +1,176 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "PieceTracer.hpp"
+#include "AlertTimestamp.hpp"
+#include "Metrics.hpp"
+#include "Hashes.hpp"
+#include "libtorrent-node/utils.hpp"
+
+#include <libtorrent/alert_types.hpp>
+#include <libtorrent/time.hpp>
+
+#include <cstring>
+#include <utility>
+
+namespace joystream {
+namespace node {
+namespace piece_tracer {
+
+  namespace {
+
+    // Bound on queued samples
+    const std::size_t MaxSamples = 65536;
+
+    metrics::Histogram * histograms[] = {
+      &metrics::histogram("piece_latency_ns.request_to_send"),
+      &metrics::histogram("piece_latency_ns.send_to_payment"),
+      &metrics::histogram("piece_latency_ns.arrival_to_payment")
+    };
+
+    uint32_t indexOf(const libtorrent::sha1_hash & h, std::vector<libtorrent::sha1_hash> & list, std::map<libtorrent::sha1_hash, uint32_t> & indexes) {
+
+      auto it = indexes.find(h);
+
+      if(it != indexes.end())
+        return it->second;
+
+      uint32_t i = (uint32_t)list.size();
+
+      list.push_back(h);
+      indexes.insert(std::make_pair(h, i));
+
+      return i;
+    }
+
+    template<class T>
+    void copyColumn(const std::vector<T> & column, char * data, std::size_t & offset) {
+      std::memcpy(data + offset, column.data(), column.size() * sizeof(T));
+      offset += column.size() * sizeof(T);
+    }
+
+  }
+
+  NAN_MODULE_INIT(Init) {
+
+    v8::Local<v8::Object> stages = Nan::New<v8::Object>();
+
+    SET_NUMBER(stages, "RequestToSend", (int)Stage::RequestToSend);
+    SET_NUMBER(stages, "SendToPayment", (int)Stage::SendToPayment);
+    SET_NUMBER(stages, "ArrivalToPayment", (int)Stage::ArrivalToPayment);
+
+    SET_VAL(target, "PieceLatencyStage", stages);
+  }
+
+  void Samples::clear() {
+    latency.clear();
+    timestamp.clear();
+    torrentIndex.clear();
+    peerIndex.clear();
+    pieceIndex.clear();
+    stage.clear();
+  }
+
+  Tracer::Tracer()
+    : _enabled(false)
+    , _dropped(0) {
+  }
+
+  void Tracer::setEnabled(bool enable) {
+
+    _enabled = enable;
+
+    if(!enable)
+      clear();
+  }
+
+  void Tracer::sample(const libtorrent::peer_alert * p, const piece_progress::Ended & ended) {
+
+    if(!_enabled)
+      return;
+
+    libtorrent::time_duration latency = ended.end - ended.start;
+
+    histograms[static_cast<int>(ended.stage)]->record(libtorrent::total_microseconds(latency) * 1000);
+
+    if(_samples.size() >= MaxSamples) {
+      _dropped++;
+      return;
+    }
+
+    _samples.latency.push_back((double)libtorrent::total_microseconds(latency));
+    _samples.timestamp.push_back(alert_timestamp::encode(p));
+    _samples.torrentIndex.push_back(indexOf(p->handle.info_hash(), _torrents, _torrentIndexes));
+    _samples.peerIndex.push_back(indexOf(p->pid, _peers, _peerIndexes));
+    _samples.pieceIndex.push_back(ended.pieceIndex);
+    _samples.stage.push_back((uint8_t)ended.stage);
+  }
+
+  v8::Local<v8::Value> Tracer::take() {
+
+    if(_samples.size() == 0 && _dropped == 0)
+      return Nan::Undefined();
+
+    const std::size_t n = _samples.size();
+    const std::size_t byteLength = n * (2 * sizeof(double) + 2 * sizeof(uint32_t) + sizeof(int32_t) + sizeof(uint8_t));
+
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), byteLength);
+    char * data = static_cast<char *>(buffer->GetContents().Data());
+
+    v8::Local<v8::Array> torrentList = Nan::New<v8::Array>();
+    for(auto & h : _torrents)
+      torrentList->Set(torrentList->Length(), hashes::encodeInfoHash(h));
+
+    v8::Local<v8::Array> peerList = Nan::New<v8::Array>();
+    for(auto & pid : _peers)
+      peerList->Set(peerList->Length(), hashes::encodePeerId(pid));
+
+    v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+    SET_VAL(o, "torrents", torrentList);
+    SET_VAL(o, "peers", peerList);
+    SET_NUMBER(o, "length", n);
+    SET_NUMBER(o, "dropped", _dropped);
+    SET_VAL(o, "buffer", buffer);
+
+    // Widest columns come first, so every view is aligned
+    std::size_t offset = 0;
+
+    SET_VAL(o, "latency", v8::Float64Array::New(buffer, offset, n));
+    copyColumn(_samples.latency, data, offset);
+
+    SET_VAL(o, "timestamp", v8::Float64Array::New(buffer, offset, n));
+    copyColumn(_samples.timestamp, data, offset);
+
+    SET_VAL(o, "torrentIndex", v8::Uint32Array::New(buffer, offset, n));
+    copyColumn(_samples.torrentIndex, data, offset);
+
+    SET_VAL(o, "peerIndex", v8::Uint32Array::New(buffer, offset, n));
+    copyColumn(_samples.peerIndex, data, offset);
+
+    SET_VAL(o, "pieceIndex", v8::Int32Array::New(buffer, offset, n));
+    copyColumn(_samples.pieceIndex, data, offset);
+
+    SET_VAL(o, "stage", v8::Uint8Array::New(buffer, offset, n));
+    copyColumn(_samples.stage, data, offset);
+
+    clear();
+
+    return o;
+  }
+
+  void Tracer::clear() {
+    _samples.clear();
+    _dropped = 0;
+    _torrents.clear();
+    _torrentIndexes.clear();
+    _peers.clear();
+    _peerIndexes.clear();
+  }
+
+}
+}
+}
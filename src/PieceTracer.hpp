@@ -0,0 +1,119 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_PIECE_TRACER_HPP
+#define JOYSTREAM_NODE_PIECE_TRACER_HPP
+
+#include <nan.h>
+
+#include "PieceProgress.hpp"
+
+#include <libtorrent/sha1_hash.hpp>
+
+#include <map>
+#include <vector>
+
+namespace libtorrent {
+  struct peer_alert;
+}
+
+namespace joystream {
+namespace node {
+namespace piece_tracer {
+
+  /*
+   * Latency of stages of paid pieces, as ended by alerts, see piece_progress.
+   * Pieces are tracked per connection by connection_rates, which hands each
+   * ended stage to `sample`.
+   *
+   * Each sample is recorded in histogram "piece_latency_ns.<stage>" of metrics,
+   * and queued until taken with `take`.
+   *
+   * Only stages visible to one side of a connection are measured. Timestamps are
+   * on the alert clock of this node, see alert_timestamp, so stages seen by the
+   * other side, e.g. request to send for a buyer, cannot be recovered by joining
+   * samples of both nodes.
+   */
+
+  typedef piece_progress::Stage Stage;
+
+  // Exports "PieceLatencyStage" (Object) of Stage values
+  NAN_MODULE_INIT(Init);
+
+  // Columns of queued samples
+  struct Samples {
+
+    std::size_t size() const { return stage.size(); }
+
+    void clear();
+
+    std::vector<double> latency;
+    std::vector<double> timestamp;
+    std::vector<uint32_t> torrentIndex;
+    std::vector<uint32_t> peerIndex;
+    std::vector<int32_t> pieceIndex;
+    std::vector<uint8_t> stage;
+  };
+
+  class Tracer {
+
+  public:
+
+    Tracer();
+
+    /* @brief Starts or stops tracing, stopping forgets queued samples
+     *
+     * @param enable whether to trace
+     */
+    void setEnabled(bool enable);
+
+    /* @brief Samples stage, if tracing
+     *
+     * @param p alert which ended stage
+     * @param ended stage
+     */
+    void sample(const libtorrent::peer_alert * p, const piece_progress::Ended & ended);
+
+    /* @brief Creates javascript representation of samples since last call, and clears them.
+     *
+     * @return v8::Local<v8::Value>, undefined if there are no samples, otherwise o where
+     *
+     * {Array} o.torrents - info hashes referred to by torrentIndex
+     * {Array} o.peers - peer ids referred to by peerIndex
+     * {Number} o.length - number of samples
+     * {Number} o.dropped - samples not queued since last call, as queue was full
+     * {ArrayBuffer} o.buffer - backing store of all columns below
+     * {Float64Array} o.latency - microseconds
+     * {Float64Array} o.timestamp - microseconds when stage ended, see alert_timestamp
+     * {Uint32Array} o.torrentIndex - index into o.torrents
+     * {Uint32Array} o.peerIndex - index into o.peers
+     * {Int32Array} o.pieceIndex
+     * {Uint8Array} o.stage - Stage
+     */
+    v8::Local<v8::Value> take();
+
+  private:
+
+    // Forgets queued samples
+    void clear();
+
+    bool _enabled;
+
+    Samples _samples;
+    uint64_t _dropped;
+
+    std::vector<libtorrent::sha1_hash> _torrents;
+    std::map<libtorrent::sha1_hash, uint32_t> _torrentIndexes;
+
+    std::vector<libtorrent::peer_id> _peers;
+    std::map<libtorrent::peer_id, uint32_t> _peerIndexes;
+  };
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_PIECE_TRACER_HPP
@@ -7,6 +7,8 @@
 
 #include "Plugin.hpp"
 #include "PluginAlertEncoder.hpp"
+#include "Tracing.hpp"
+#include "Metrics.hpp"
 #include "BuyerTerms.hpp"
 #include "SellerTerms.hpp"
 #include "PrivateKey.hpp"
@@ -16,22 +18,37 @@
 #include "LibtorrentInteraction.hpp"
 #include "detail/UnhandledCallbackException.hpp"
 #include "libtorrent-node/utils.hpp"
-#include "libtorrent-node/sha1_hash.hpp"
+#include "Hashes.hpp"
 #include "libtorrent-node/add_torrent_params.hpp"
 #include "libtorrent-node/torrent_handle.h"
 #include "libtorrent-node/endpoint.hpp"
-#include "libtorrent-node/peer_id.hpp"
 #include "libtorrent-node/error_code.hpp"
 
 #include <extension/extension.hpp>
 
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
 /// Plugin utilities
-#define ARGUMENTS_REQUIRE_CALLBACK(i, var)                              \
-  ARGUMENTS_REQUIRE_FUNCTION(i, _fn)                                           \
-  std::shared_ptr<Nan::Callback> var = std::make_shared<Nan::Callback>(_fn);
+// Callback at argument i if given, otherwise method returns a promise,
+// request is the detail::Request value under which round trip is measured
+#define ARGUMENTS_OPTIONAL_COMPLETION(i, var, request)                         \
+  if(info.Length() > i && !info[i]->IsUndefined() && !info[i]->IsFunction())   \
+    return Nan::ThrowTypeError("Argument " #i " must be a function or undefined"); \
+  detail::Completion var(info.Length() > i && info[i]->IsFunction() ?          \
+                         v8::Local<v8::Function>::Cast(info[i]) :              \
+                         v8::Local<v8::Function>(),                            \
+                         detail::Request::request);
+
+#define RETURN_COMPLETION(var) RETURN(var.returnValue())
 
 #define GET_THIS_PLUGIN(var) Plugin * var = Nan::ObjectWrap::Unwrap<Plugin>(info.This());
 
+// Span of request submission, named by method
+#define TRACE_SUBMISSION tracing::Span span(__func__, "submission");
+
 /// Returned values
 
 #define TERNARY_CAST(x) ((Nan::To<v8::Object>(x)).ToLocalChecked())
@@ -49,13 +66,76 @@ namespace node {
 
 namespace detail {
 
-  joystream::extension::request::AddTorrent::AddTorrentHandler CreateAddTorrentHandler(const std::shared_ptr<Nan::Callback> & callback);
+  // Requests with a completion, each with a histogram of time from
+  // submission until completion, "request_latency_ns.<name>"
+  enum class Request {
+    Start,
+    Stop,
+    UpdateBuyerTerms,
+    UpdateSellerTerms,
+    ToObserveMode,
+    ToSellMode,
+    ToBuyMode,
+    PauseLibtorrent,
+    AddTorrent,
+    RemoveTorrent,
+    PauseTorrent,
+    ResumeTorrent,
+    StartDownloading,
+    StartUploading,
+    SetLibtorrentInteraction,
+    DropPeer,
+    SubmitBatch
+  };
+
+  /**
+   * @brief Where outcome of a request is delivered, either a node style
+   * callback, or a promise when no callback was given.
+   */
+  class Completion {
+
+  public:
+
+    // Completes with callback, or promise if callback is empty,
+    // request is assumed to be submitted right after
+    Completion(const v8::Local<v8::Function> & callback, Request request);
+
+    /* @brief Calls callback with (error, result), or resolves promise with
+     * result when error is null, and otherwise rejects it with error.
+     *
+     * @throws detail::UnhandledCallbackException if callback throws
+     */
+    void complete(const v8::Local<v8::Value> & error, const v8::Local<v8::Value> & result) const;
+
+    // Promise, or undefined when completing with callback
+    v8::Local<v8::Value> returnValue() const;
+
+  private:
+
+    std::shared_ptr<Nan::Callback> _callback;
+    // Released once settled, or with the last copy of the completion
+    std::shared_ptr<Nan::Global<v8::Promise::Resolver>> _resolver;
+
+    metrics::Histogram * _latency;
+    std::chrono::steady_clock::time_point _submitted;
+  };
+
+  joystream::extension::request::AddTorrent::AddTorrentHandler CreateAddTorrentHandler(const Completion & completion);
 
 namespace subroutine_handler {
-  joystream::extension::request::SubroutineHandler CreateGenericHandler(const std::shared_ptr<Nan::Callback> & callback);
+  joystream::extension::request::SubroutineHandler CreateGenericHandler(const Completion & completion);
 }
 namespace no_exception_subroutine_handler {
-  joystream::extension::request::NoExceptionSubroutineHandler CreateGenericHandler(const std::shared_ptr<Nan::Callback> & callback);
+  joystream::extension::request::NoExceptionSubroutineHandler CreateGenericHandler(const Completion & completion);
+}
+namespace batch {
+
+  // Submits request of a batch item, with given handler
+  typedef std::function<void(const joystream::extension::request::SubroutineHandler &)> Submitter;
+
+  Submitter DecodeItem(const boost::shared_ptr<joystream::extension::Plugin> & plugin, const v8::Local<v8::Value> & item);
+
+  std::vector<joystream::extension::request::SubroutineHandler> CreateItemHandlers(const Completion & completion, std::size_t size);
 }
 }
 
@@ -88,13 +168,35 @@ NAN_MODULE_INIT(Plugin::Init) {
   Nan::SetPrototypeMethod(tpl, "start_uploading", StartUploading);
   Nan::SetPrototypeMethod(tpl, "set_libtorrent_interaction", SetLibtorrentInteraction);
   Nan::SetPrototypeMethod(tpl, "dropPeer", DropPeer);
+  Nan::SetPrototypeMethod(tpl, "set_alert_filter", SetAlertFilter);
+  Nan::SetPrototypeMethod(tpl, "set_alert_subscriptions", SetAlertSubscriptions);
+  Nan::SetPrototypeMethod(tpl, "set_payment_alert_batching", SetPaymentAlertBatching);
+  Nan::SetPrototypeMethod(tpl, "take_payment_alert_batch", TakePaymentAlertBatch);
+  Nan::SetPrototypeMethod(tpl, "set_status_update_deltas", SetStatusUpdateDeltas);
+  Nan::SetPrototypeMethod(tpl, "take_status_deltas", TakeStatusDeltas);
+  Nan::SetPrototypeMethod(tpl, "set_peer_status_batching", SetPeerStatusBatching);
+  Nan::SetPrototypeMethod(tpl, "take_peer_status_batch", TakePeerStatusBatch);
+  Nan::SetPrototypeMethod(tpl, "submit_batch", SubmitBatch);
+  Nan::SetPrototypeMethod(tpl, "set_request_result_coalescing", SetRequestResultCoalescing);
+  Nan::SetPrototypeMethod(tpl, "run_request_results", RunRequestResults);
+  Nan::SetPrototypeMethod(tpl, "torrent_slot", TorrentSlot);
+  Nan::SetPrototypeMethod(tpl, "recycle_torrent_slots", RecycleTorrentSlots);
+  Nan::SetPrototypeMethod(tpl, "alert_pop_ended", AlertPopEnded);
+  Nan::SetPrototypeMethod(tpl, "set_alert_routing", SetAlertRouting);
+  Nan::SetPrototypeMethod(tpl, "take_routed_alerts", TakeRoutedAlerts);
+  Nan::SetPrototypeMethod(tpl, "connection_rates", ConnectionRates);
+  Nan::SetPrototypeMethod(tpl, "set_piece_tracing", SetPieceTracing);
+  Nan::SetPrototypeMethod(tpl, "take_piece_latency_samples", TakePieceLatencySamples);
 
   constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
   Nan::Set(target, Nan::New("Plugin").ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
 }
 
 libtorrent::node::AlertEncoder Plugin::getEncoder() const noexcept {
-  return PluginAlertEncoder::alertEncoder;
+
+  std::shared_ptr<PluginAlertEncoder::Encoder> encoder = _encoder;
+
+  return [encoder](const libtorrent::alert * a) { return (*encoder)(a); };
 }
 
 boost::shared_ptr<libtorrent::plugin> Plugin::getPlugin() const noexcept {
@@ -102,7 +204,8 @@ boost::shared_ptr<libtorrent::plugin> Plugin::getPlugin() const noexcept {
 }
 
 Plugin::Plugin(const boost::shared_ptr<extension::Plugin> & plugin)
-  : _plugin(plugin) {
+  : _plugin(plugin)
+  , _encoder(std::make_shared<PluginAlertEncoder::Encoder>()) {
 }
 
 NAN_METHOD(Plugin::New) {
@@ -124,133 +227,141 @@ NAN_METHOD(Plugin::Start) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(1, managedCallback)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+  ARGUMENTS_OPTIONAL_COMPLETION(1, completion, Start)
 
   // Create request
   joystream::extension::request::Start request(infoHash,
-                                               detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                               detail::subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::Stop) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(1, managedCallback)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+  ARGUMENTS_OPTIONAL_COMPLETION(1, completion, Stop)
 
   // Create request
   joystream::extension::request::Stop request(infoHash,
-                                              detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                              detail::subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::UpdateBuyerTerms) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
   ARGUMENTS_REQUIRE_DECODED(1, buyerTerms, protocol_wire::BuyerTerms, node::buyer_terms::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(2, managedCallback)
+  ARGUMENTS_OPTIONAL_COMPLETION(2, completion, UpdateBuyerTerms)
 
   // Create request
   joystream::extension::request::UpdateBuyerTerms request(infoHash,
                                                           buyerTerms,
-                                                          detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                          detail::subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::UpdateSellerTerms) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
   ARGUMENTS_REQUIRE_DECODED(1, sellerTerms, protocol_wire::SellerTerms, node::seller_terms::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(2, managedCallback)
+  ARGUMENTS_OPTIONAL_COMPLETION(2, completion, UpdateSellerTerms)
 
   // Create request
   joystream::extension::request::UpdateSellerTerms request(infoHash,
                                                            sellerTerms,
-                                                           detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                           detail::subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::ToObserveMode) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(1, managedCallback)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+  ARGUMENTS_OPTIONAL_COMPLETION(1, completion, ToObserveMode)
 
   // Create request
   joystream::extension::request::ToObserveMode request(infoHash,
-                                                       detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                       detail::subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::ToSellMode) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
   ARGUMENTS_REQUIRE_DECODED(1, sellerTerms, protocol_wire::SellerTerms, node::seller_terms::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(2, managedCallback)
+  ARGUMENTS_OPTIONAL_COMPLETION(2, completion, ToSellMode)
 
   // Create request
   joystream::extension::request::ToSellMode request(infoHash,
                                                     sellerTerms,
-                                                    detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                    detail::subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::ToBuyMode) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
   ARGUMENTS_REQUIRE_DECODED(1, buyerTerms, protocol_wire::BuyerTerms, node::buyer_terms::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(2, managedCallback)
+  ARGUMENTS_OPTIONAL_COMPLETION(2, completion, ToBuyMode)
 
   // Create request
   joystream::extension::request::ToBuyMode request(infoHash,
                                                    buyerTerms,
-                                                   detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                   detail::subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::PostTorrentPluginStatusUpdates) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
+  TRACE_SUBMISSION
 
   // Create request
   joystream::extension::request::PostTorrentPluginStatusUpdates request;
@@ -265,13 +376,41 @@ NAN_METHOD(Plugin::PostPeerPluginStatusUpdates) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
+  TRACE_SUBMISSION
 
-  // Create request
-  joystream::extension::request::PostPeerPluginStatusUpdates request(infoHash);
+  if(info.Length() < 1 || !info[0]->IsArray()) {
 
-  // Submit request
-  plugin->_plugin->submit(request);
+    ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+
+    // Create request
+    joystream::extension::request::PostPeerPluginStatusUpdates request(infoHash);
+
+    // Submit request
+    plugin->_plugin->submit(request);
+
+    RETURN_VOID
+  }
+
+  // Decode all info hashes before submitting any request
+  v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(info[0]);
+  std::vector<libtorrent::sha1_hash> infoHashes;
+
+  infoHashes.reserve(array->Length());
+
+  try {
+
+    for(uint32_t i = 0;i < array->Length();i++)
+      infoHashes.push_back(hashes::decodeInfoHash(Nan::Get(array, i).ToLocalChecked()));
+
+  } catch(const std::exception & e) {
+    return Nan::ThrowTypeError(e.what());
+  }
+
+  // Submit request for each torrent
+  for(auto & infoHash : infoHashes) {
+    joystream::extension::request::PostPeerPluginStatusUpdates request(infoHash);
+    plugin->_plugin->submit(request);
+  }
 
   RETURN_VOID
 }
@@ -280,26 +419,28 @@ NAN_METHOD(Plugin::PauseLibtorrent) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_CALLBACK(0, managedCallback)
+  TRACE_SUBMISSION
+  ARGUMENTS_OPTIONAL_COMPLETION(0, completion, PauseLibtorrent)
 
   // Create request
-  joystream::extension::request::PauseLibtorrent request(detail::no_exception_subroutine_handler::CreateGenericHandler(managedCallback));
+  joystream::extension::request::PauseLibtorrent request(detail::no_exception_subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::AddTorrent) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
+  TRACE_SUBMISSION
 
   ARGUMENTS_REQUIRE_DECODED(0, addTorrentParams, libtorrent::add_torrent_params, libtorrent::node::add_torrent_params::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(1, managedCallback)
+  ARGUMENTS_OPTIONAL_COMPLETION(1, completion, AddTorrent)
 
-  joystream::extension::request::AddTorrent::AddTorrentHandler addTorrentHandler = detail::CreateAddTorrentHandler(managedCallback);
+  joystream::extension::request::AddTorrent::AddTorrentHandler addTorrentHandler = detail::CreateAddTorrentHandler(completion);
 
   // When this flag is set, attempting add a duplicate torrent to the session
   // with add_torrent method will result in the error code `duplicate_torrent`
@@ -312,94 +453,99 @@ NAN_METHOD(Plugin::AddTorrent) {
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::RemoveTorrent) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(1, managedCallback)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+  ARGUMENTS_OPTIONAL_COMPLETION(1, completion, RemoveTorrent)
 
   // Create request
   joystream::extension::request::RemoveTorrent request(infoHash,
-                                                       detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                       detail::subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::PauseTorrent) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
   ARGUMENTS_REQUIRE_BOOLEAN(1, graceful)
-  ARGUMENTS_REQUIRE_CALLBACK(2, managedCallback)
+  ARGUMENTS_OPTIONAL_COMPLETION(2, completion, PauseTorrent)
 
   // Create request
   joystream::extension::request::PauseTorrent request(infoHash,
                                                       graceful,
-                                                      detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                      detail::subroutine_handler::CreateGenericHandler(completion));
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::ResumeTorrent) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(1, managedCallback)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+  ARGUMENTS_OPTIONAL_COMPLETION(1, completion, ResumeTorrent)
 
   // Create request
   joystream::extension::request::ResumeTorrent request(infoHash,
-                                                       detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                       detail::subroutine_handler::CreateGenericHandler(completion));
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::StartDownloading) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
   ARGUMENTS_REQUIRE_DECODED(1, contractTx, Coin::Transaction, joystream::node::transaction::decode)
   ARGUMENTS_REQUIRE_DECODED(2,
                             peerToStartDownloadInformationMap,
                             protocol_session::PeerToStartDownloadInformationMap<libtorrent::peer_id>,
                             joystream::node::PeerToStartDownloadInformationMap::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(3, managedCallback)
+  ARGUMENTS_OPTIONAL_COMPLETION(3, completion, StartDownloading)
 
   // Create request
   joystream::extension::request::StartDownloading request(infoHash,
                                                           contractTx,
                                                           peerToStartDownloadInformationMap,
-                                                          detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                          detail::subroutine_handler::CreateGenericHandler(completion));
 
   // Submit request
   plugin->_plugin->submit(request);
 
-  RETURN_VOID
+  RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::StartUploading) {
 
   // Get validated parameters
   GET_THIS_PLUGIN(plugin)
-  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
-  ARGUMENTS_REQUIRE_DECODED(1, peerId, libtorrent::peer_id, libtorrent::node::peer_id::decode)
+  TRACE_SUBMISSION
+  ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+  ARGUMENTS_REQUIRE_DECODED(1, peerId, libtorrent::peer_id, hashes::decodePeerId)
   ARGUMENTS_REQUIRE_DECODED(2, buyerTerms, protocol_wire::BuyerTerms, joystream::node::buyer_terms::decode)
   ARGUMENTS_REQUIRE_DECODED(3, contractSk, Coin::PrivateKey, joystream::node::private_key::decode)
   ARGUMENTS_REQUIRE_DECODED(4, finalPkHash, Coin::PubKeyHash, joystream::node::pubkey_hash::decode)
-  ARGUMENTS_REQUIRE_CALLBACK(5, managedCallback)
+  ARGUMENTS_OPTIONAL_COMPLETION(5, completion, StartUploading)
 
   Coin::KeyPair contractKeyPair(contractSk);
 
@@ -409,33 +555,34 @@ NAN_METHOD(Plugin::StartUploading) {
                                                         buyerTerms,
                                                         contractKeyPair,
                                                         finalPkHash,
-                                                        detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                        detail::subroutine_handler::CreateGenericHandler(completion));
 
     // Submit request
     plugin->_plugin->submit(request);
 
-    RETURN_VOID
+    RETURN_COMPLETION(completion)
 }
 
 NAN_METHOD(Plugin::SetLibtorrentInteraction) {
 
     // Get validated parameters
     GET_THIS_PLUGIN(plugin)
-    ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
+    TRACE_SUBMISSION
+    ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
     ARGUMENTS_REQUIRE_DECODED(1, libtorrentInteraction,
                               joystream::extension::TorrentPlugin::LibtorrentInteraction,
                               joystream::node::libtorrent_interaction::decode)
-    ARGUMENTS_REQUIRE_CALLBACK(2, managedCallback)
+    ARGUMENTS_OPTIONAL_COMPLETION(2, completion, SetLibtorrentInteraction)
 
     // Create request
     joystream::extension::request::SetLibtorrentInteraction request(infoHash,
                                                                     libtorrentInteraction,
-                                                                    detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                                    detail::subroutine_handler::CreateGenericHandler(completion));
 
     // Submit request
     plugin->_plugin->submit(request);
 
-    RETURN_VOID
+    RETURN_COMPLETION(completion)
 }
 
 
@@ -443,21 +590,254 @@ NAN_METHOD(Plugin::DropPeer) {
 
     // Get validated parameters
     GET_THIS_PLUGIN(plugin)
-    ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, libtorrent::node::sha1_hash::decode)
-    ARGUMENTS_REQUIRE_DECODED(1, peerId, libtorrent::peer_id, libtorrent::node::peer_id::decode)
-    ARGUMENTS_REQUIRE_CALLBACK(2, managedCallback)
+    TRACE_SUBMISSION
+    ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+    ARGUMENTS_REQUIRE_DECODED(1, peerId, libtorrent::peer_id, hashes::decodePeerId)
+    ARGUMENTS_OPTIONAL_COMPLETION(2, completion, DropPeer)
 
     // Create request
     joystream::extension::request::DropPeer request(infoHash,
                                                     peerId,
-                                                    detail::subroutine_handler::CreateGenericHandler(managedCallback));
+                                                    detail::subroutine_handler::CreateGenericHandler(completion));
 
     // Submit request
     plugin->_plugin->submit(request);
 
+    RETURN_COMPLETION(completion)
+}
+
+NAN_METHOD(Plugin::SetAlertFilter) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    std::set<int> types;
+
+    // No argument clears filter
+    if(info.Length() > 0 && !info[0]->IsUndefined() && !info[0]->IsNull()) {
+
+      if(!info[0]->IsArray())
+        return Nan::ThrowTypeError("Argument must be array of alert types");
+
+      v8::Local<v8::Array> array = v8::Local<v8::Array>::Cast(info[0]);
+
+      for(uint32_t i = 0;i < array->Length();i++)
+        types.insert(ToNative<int32_t>(Nan::Get(array, i).ToLocalChecked()));
+    }
+
+    plugin->_encoder->setAlertFilter(types);
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::SetAlertSubscriptions) {
+
+    GET_THIS_PLUGIN(plugin)
+    ARGUMENTS_REQUIRE_NUMBER(0, mask)
+
+    plugin->_encoder->setAlertSubscriptions((uint32_t)mask);
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::SetPaymentAlertBatching) {
+
+    GET_THIS_PLUGIN(plugin)
+    ARGUMENTS_REQUIRE_BOOLEAN(0, enable)
+
+    plugin->_encoder->setPaymentAlertBatching(enable);
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::TakePaymentAlertBatch) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    RETURN(plugin->_encoder->paymentAlerts.take())
+}
+
+NAN_METHOD(Plugin::SetStatusUpdateDeltas) {
+
+    GET_THIS_PLUGIN(plugin)
+    ARGUMENTS_REQUIRE_BOOLEAN(0, enable)
+
+    plugin->_encoder->setStatusUpdateDeltas(enable);
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::TakeStatusDeltas) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    RETURN(plugin->_encoder->statusDeltas.take())
+}
+
+NAN_METHOD(Plugin::SetPeerStatusBatching) {
+
+    GET_THIS_PLUGIN(plugin)
+    ARGUMENTS_REQUIRE_BOOLEAN(0, enable)
+
+    plugin->_encoder->setPeerStatusBatching(enable);
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::TakePeerStatusBatch) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    RETURN(plugin->_encoder->peerStatuses.take())
+}
+
+NAN_METHOD(Plugin::SubmitBatch) {
+
+    // Get validated parameters
+    GET_THIS_PLUGIN(plugin)
+    TRACE_SUBMISSION
+
+    if(info.Length() < 1 || !info[0]->IsArray())
+      return Nan::ThrowTypeError("Argument 0 must be array of requests");
+
+    ARGUMENTS_OPTIONAL_COMPLETION(1, completion, SubmitBatch)
+
+    // Decode all items before submitting any request, so a
+    // malformed batch is rejected as a whole
+    v8::Local<v8::Array> items = v8::Local<v8::Array>::Cast(info[0]);
+    std::vector<detail::batch::Submitter> submitters;
+
+    // Request would never complete
+    if(items->Length() == 0)
+      return Nan::ThrowTypeError("Argument 0 must not be empty");
+
+    submitters.reserve(items->Length());
+
+    for(uint32_t i = 0;i < items->Length();i++) {
+
+      try {
+        submitters.push_back(detail::batch::DecodeItem(plugin->_plugin, Nan::Get(items, i).ToLocalChecked()));
+      } catch(const std::exception & e) {
+        return Nan::ThrowTypeError((std::string("Request ") + std::to_string(i) + ": " + e.what()).c_str());
+      }
+    }
+
+    // Submit requests, callback is called once with outcome of all of them
+    std::vector<joystream::extension::request::SubroutineHandler> handlers = detail::batch::CreateItemHandlers(completion, submitters.size());
+
+    for(std::size_t i = 0;i < submitters.size();i++)
+      submitters[i](handlers[i]);
+
+    RETURN_COMPLETION(completion)
+}
+
+NAN_METHOD(Plugin::SetRequestResultCoalescing) {
+
+    GET_THIS_PLUGIN(plugin)
+    ARGUMENTS_REQUIRE_BOOLEAN(0, enable)
+
+    plugin->_encoder->setRequestResultCoalescing(enable);
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::RunRequestResults) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    // Same reporting of unhandled exceptions as RequestResult::Run
+    try {
+        plugin->_encoder->requestResults.run();
+    } catch(const detail::UnhandledCallbackException & e) {
+
+        v8::MaybeLocal<v8::String> exception_as_string = e.exception->ToString();
+
+        Nan::ThrowError(exception_as_string.ToLocalChecked());
+    }
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::TorrentSlot) {
+
+    GET_THIS_PLUGIN(plugin)
+    ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+
+    int32_t slot = plugin->_encoder->torrentSlots.slot(infoHash);
+
+    if(slot == torrent_slots::None) {
+      RETURN(Nan::Undefined())
+    }
+
+    RETURN(Nan::New<v8::Int32>(slot))
+}
+
+NAN_METHOD(Plugin::RecycleTorrentSlots) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    plugin->_encoder->torrentSlots.recycle();
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::AlertPopEnded) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    // Called once right after every pop
+    plugin->_encoder->popEnded();
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::SetAlertRouting) {
+
+    GET_THIS_PLUGIN(plugin)
+    ARGUMENTS_REQUIRE_BOOLEAN(0, enable)
+
+    plugin->_encoder->setAlertRouting(enable);
+
+    RETURN_VOID
+}
+
+NAN_METHOD(Plugin::TakeRoutedAlerts) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    RETURN(plugin->_encoder->routedAlerts.take())
+}
+
+NAN_METHOD(Plugin::ConnectionRates) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    // No argument gives connections of all torrents
+    if(info.Length() < 1 || info[0]->IsUndefined()) {
+      RETURN(plugin->_encoder->connectionRates.encode())
+    }
+
+    ARGUMENTS_REQUIRE_DECODED(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+
+    RETURN(plugin->_encoder->connectionRates.encode(infoHash))
+}
+
+NAN_METHOD(Plugin::SetPieceTracing) {
+
+    GET_THIS_PLUGIN(plugin)
+    ARGUMENTS_REQUIRE_BOOLEAN(0, enable)
+
+    plugin->_encoder->pieceTracer.setEnabled(enable);
+
     RETURN_VOID
 }
 
+NAN_METHOD(Plugin::TakePieceLatencySamples) {
+
+    GET_THIS_PLUGIN(plugin)
+
+    RETURN(plugin->_encoder->pieceTracer.take())
+}
+
 namespace detail {
 
     void safe_callback_dispatcher(const std::shared_ptr<Nan::Callback> & callback, int argc, v8::Local<v8::Value> argv[]) {
@@ -471,25 +851,95 @@ namespace detail {
             throw detail::UnhandledCallbackException(trap.Exception());
     }
 
+  /// Completion
+
+  static metrics::Counter & requestsCompleted = metrics::counter("requests_completed");
+  static metrics::Counter & requestsFailed = metrics::counter("requests_failed");
+
+  // Time spent in callbacks, or settling promises, of requests
+  static metrics::Histogram & callbackDispatch = metrics::histogram("callback_dispatch_ns");
+
+  // Indexed by Request
+  static metrics::Histogram * requestLatency[] = {
+    &metrics::histogram("request_latency_ns.start"),
+    &metrics::histogram("request_latency_ns.stop"),
+    &metrics::histogram("request_latency_ns.update_buyer_terms"),
+    &metrics::histogram("request_latency_ns.update_seller_terms"),
+    &metrics::histogram("request_latency_ns.to_observe_mode"),
+    &metrics::histogram("request_latency_ns.to_sell_mode"),
+    &metrics::histogram("request_latency_ns.to_buy_mode"),
+    &metrics::histogram("request_latency_ns.pause_libtorrent"),
+    &metrics::histogram("request_latency_ns.add_torrent"),
+    &metrics::histogram("request_latency_ns.remove_torrent"),
+    &metrics::histogram("request_latency_ns.pause_torrent"),
+    &metrics::histogram("request_latency_ns.resume_torrent"),
+    &metrics::histogram("request_latency_ns.start_downloading"),
+    &metrics::histogram("request_latency_ns.start_uploading"),
+    &metrics::histogram("request_latency_ns.set_libtorrent_interaction"),
+    &metrics::histogram("request_latency_ns.drop_peer"),
+    &metrics::histogram("request_latency_ns.submit_batch")
+  };
+
+  Completion::Completion(const v8::Local<v8::Function> & callback, Request request)
+    : _latency(requestLatency[static_cast<int>(request)])
+    , _submitted(std::chrono::steady_clock::now()) {
+
+    if(!callback.IsEmpty())
+      _callback = std::make_shared<Nan::Callback>(callback);
+    else
+      _resolver = std::make_shared<Nan::Global<v8::Promise::Resolver>>(v8::Promise::Resolver::New(Nan::GetCurrentContext()).ToLocalChecked());
+  }
+
+  void Completion::complete(const v8::Local<v8::Value> & error, const v8::Local<v8::Value> & result) const {
+
+    tracing::Span span("Completion::complete", "callback");
+
+    _latency->record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _submitted).count());
+
+    if(error->IsNull())
+      requestsCompleted.add();
+    else
+      requestsFailed.add();
+
+    metrics::Timer timer(callbackDispatch);
+
+    if(_callback) {
+      v8::Local<v8::Value> argv[] = { error, result };
+      safe_callback_dispatcher(_callback, 2, argv);
+      return;
+    }
+
+    // Settling only queues reactions, so nothing runs here
+    v8::Local<v8::Promise::Resolver> resolver = Nan::New(*_resolver);
+
+    if(error->IsNull())
+      resolver->Resolve(Nan::GetCurrentContext(), result).FromJust();
+    else if(error->IsString())
+      resolver->Reject(Nan::GetCurrentContext(), Nan::Error(v8::Local<v8::String>::Cast(error))).FromJust();
+    else
+      resolver->Reject(Nan::GetCurrentContext(), error).FromJust();
+
+    _resolver->Reset();
+  }
+
+  v8::Local<v8::Value> Completion::returnValue() const {
+
+    if(_callback)
+      return Nan::Undefined();
+
+    return Nan::New(*_resolver)->GetPromise();
+  }
+
   /// Custom handlers
 
-  joystream::extension::request::AddTorrent::AddTorrentHandler CreateAddTorrentHandler(const std::shared_ptr<Nan::Callback> & callback) {
+  joystream::extension::request::AddTorrent::AddTorrentHandler CreateAddTorrentHandler(const Completion & completion) {
 
-    return [callback] (libtorrent::error_code & ec, libtorrent::torrent_handle & h) -> void {
+    return [completion] (libtorrent::error_code & ec, libtorrent::torrent_handle & h) -> void {
 
-      if (ec) {
-        v8::Local<v8::Value> argv[] = {
-          libtorrent::node::error_code::encode(ec),
-          Nan::Undefined()
-        };
-        safe_callback_dispatcher(callback, 2, argv);
-      } else {
-        v8::Local<v8::Value> argv[] = {
-          Nan::Null(),
-          TorrentHandle::New(h)
-        };
-        safe_callback_dispatcher(callback, 2, argv);
-      }
+      if (ec)
+        completion.complete(libtorrent::node::error_code::encode(ec), Nan::Undefined());
+      else
+        completion.complete(Nan::Null(), TorrentHandle::New(h));
     };
 
   }
@@ -537,16 +987,15 @@ namespace detail {
       }
     }
 
-    joystream::extension::request::SubroutineHandler CreateGenericHandler(const std::shared_ptr<Nan::Callback> & callback) {
+    joystream::extension::request::SubroutineHandler CreateGenericHandler(const Completion & completion) {
 
         // Due to clang variadic template handling bug
         // http://stackoverflow.com/questions/42277528/why-does-the-following-example-not-compile-on-clang?noredirect=1#comment71713002_42277528
         // we cannot do this
         // return CreateSubroutineHandler(callback, &errorValueGn, &resultValueGn);
 
-        return [callback] (const std::exception_ptr & ex) -> void {
-          v8::Local<v8::Value> argv[] = { errorValueGn(ex), resultValueGn(ex) };
-          safe_callback_dispatcher(callback, 2, argv);
+        return [completion] (const std::exception_ptr & ex) -> void {
+          completion.complete(errorValueGn(ex), resultValueGn(ex));
         };
 
     }
@@ -582,21 +1031,216 @@ namespace detail {
       return RESULT_VALUE_SUCCESS;
     }
 
-    joystream::extension::request::NoExceptionSubroutineHandler CreateGenericHandler(const std::shared_ptr<Nan::Callback> & callback) {
+    joystream::extension::request::NoExceptionSubroutineHandler CreateGenericHandler(const Completion & completion) {
 
       // Due to clang variadic template handling bug
       // http://stackoverflow.com/questions/42277528/why-does-the-following-example-not-compile-on-clang?noredirect=1#comment71713002_42277528
       // we cannot do this
       // return CreateHandler<>(callback, &genericErrorValueGenerator, &genericResultValueGenerator);
 
-      return [callback] () -> void {
-        v8::Local<v8::Value> argv[] = { genericErrorValueGenerator(), genericResultValueGenerator() };
-        safe_callback_dispatcher(callback, 2, argv);
+      return [completion] () -> void {
+        completion.complete(genericErrorValueGenerator(), genericResultValueGenerator());
       };
     }
 
   }
 
+  /// Batch
+
+  namespace batch {
+
+    // Outcome of each request in batch
+    class Outcomes {
+
+    public:
+
+      Outcomes(const Completion & completion, std::size_t size)
+        : _completion(completion)
+        , _errors(size)
+        , _remaining(size) {
+      }
+
+      /* @brief Records outcome of item, and completes with (null, {results, errors})
+       * when all are known, where results[i] is true and errors[i] is null, or
+       * results[i] is undefined and errors[i] is the error message.
+       */
+      void done(std::size_t i, const std::exception_ptr & ex) {
+
+        _errors[i] = ex;
+
+        if(--_remaining > 0)
+          return;
+
+        v8::Local<v8::Array> results = Nan::New<v8::Array>((int)_errors.size());
+        v8::Local<v8::Array> errors = Nan::New<v8::Array>((int)_errors.size());
+
+        for(std::size_t j = 0;j < _errors.size();j++) {
+          Nan::Set(results, (uint32_t)j, subroutine_handler::resultValueGn(_errors[j]));
+          Nan::Set(errors, (uint32_t)j, subroutine_handler::errorValueGn(_errors[j]));
+        }
+
+        v8::Local<v8::Object> o = Nan::New<v8::Object>();
+        SET_VAL(o, "results", results);
+        SET_VAL(o, "errors", errors);
+
+        _completion.complete(ERROR_VALUE_SUCCESS, o);
+      }
+
+    private:
+
+      Completion _completion;
+      std::vector<std::exception_ptr> _errors;
+      std::size_t _remaining;
+    };
+
+    std::vector<joystream::extension::request::SubroutineHandler> CreateItemHandlers(const Completion & completion, std::size_t size) {
+
+      std::vector<joystream::extension::request::SubroutineHandler> handlers;
+      auto outcomes = std::make_shared<Outcomes>(completion, size);
+
+      for(std::size_t i = 0;i < size;i++)
+        handlers.push_back([outcomes, i] (const std::exception_ptr & ex) -> void { outcomes->done(i, ex); });
+
+      return handlers;
+    }
+
+    template<class T, class Decoder>
+    T decodeArgument(const v8::Local<v8::Array> & args, uint32_t i, Decoder decoder) {
+
+      if(i >= args->Length())
+        throw std::runtime_error(std::string("missing argument ") + std::to_string(i));
+
+      return decoder(Nan::Get(args, i).ToLocalChecked());
+    }
+
+    #define DECODE_ARGUMENT(i, var, type, decoder) type var = decodeArgument<type>(args, i, decoder);
+
+    // Same as ARGUMENTS_REQUIRE_BOOLEAN, no coercion
+    bool decodeBoolean(const v8::Local<v8::Value> & v) {
+
+      if(!v->IsBoolean())
+        throw std::runtime_error("argument must be a boolean");
+
+      return Nan::To<bool>(v).FromJust();
+    }
+
+    // Item is {method, args}, where method is name of plugin method and args are its
+    // arguments without the callback
+    Submitter DecodeItem(const boost::shared_ptr<joystream::extension::Plugin> & plugin, const v8::Local<v8::Value> & item) {
+
+      if(!item->IsObject())
+        throw std::runtime_error("must be object");
+
+      v8::Local<v8::Object> o = Nan::To<v8::Object>(item).ToLocalChecked();
+      v8::Local<v8::Value> methodValue = Nan::Get(o, Nan::New("method").ToLocalChecked()).ToLocalChecked();
+      v8::Local<v8::Value> argsValue = Nan::Get(o, Nan::New("args").ToLocalChecked()).ToLocalChecked();
+
+      if(!methodValue->IsString())
+        throw std::runtime_error("method must be string");
+
+      if(!argsValue->IsArray())
+        throw std::runtime_error("args must be array");
+
+      std::string method(*Nan::Utf8String(methodValue));
+      v8::Local<v8::Array> args = v8::Local<v8::Array>::Cast(argsValue);
+
+      using namespace joystream::extension;
+
+      DECODE_ARGUMENT(0, infoHash, libtorrent::sha1_hash, hashes::decodeInfoHash)
+
+      if(method == "start")
+        return [plugin, infoHash] (const request::SubroutineHandler & handler) {
+          request::Start request(infoHash, handler);
+          plugin->submit(request);
+        };
+      else if(method == "stop")
+        return [plugin, infoHash] (const request::SubroutineHandler & handler) {
+          request::Stop request(infoHash, handler);
+          plugin->submit(request);
+        };
+      else if(method == "update_buyer_terms") {
+        DECODE_ARGUMENT(1, buyerTerms, protocol_wire::BuyerTerms, node::buyer_terms::decode)
+        return [plugin, infoHash, buyerTerms] (const request::SubroutineHandler & handler) {
+          request::UpdateBuyerTerms request(infoHash, buyerTerms, handler);
+          plugin->submit(request);
+        };
+      } else if(method == "update_seller_terms") {
+        DECODE_ARGUMENT(1, sellerTerms, protocol_wire::SellerTerms, node::seller_terms::decode)
+        return [plugin, infoHash, sellerTerms] (const request::SubroutineHandler & handler) {
+          request::UpdateSellerTerms request(infoHash, sellerTerms, handler);
+          plugin->submit(request);
+        };
+      } else if(method == "to_observe_mode")
+        return [plugin, infoHash] (const request::SubroutineHandler & handler) {
+          request::ToObserveMode request(infoHash, handler);
+          plugin->submit(request);
+        };
+      else if(method == "to_sell_mode") {
+        DECODE_ARGUMENT(1, sellerTerms, protocol_wire::SellerTerms, node::seller_terms::decode)
+        return [plugin, infoHash, sellerTerms] (const request::SubroutineHandler & handler) {
+          request::ToSellMode request(infoHash, sellerTerms, handler);
+          plugin->submit(request);
+        };
+      } else if(method == "to_buy_mode") {
+        DECODE_ARGUMENT(1, buyerTerms, protocol_wire::BuyerTerms, node::buyer_terms::decode)
+        return [plugin, infoHash, buyerTerms] (const request::SubroutineHandler & handler) {
+          request::ToBuyMode request(infoHash, buyerTerms, handler);
+          plugin->submit(request);
+        };
+      } else if(method == "remove_torrent")
+        return [plugin, infoHash] (const request::SubroutineHandler & handler) {
+          request::RemoveTorrent request(infoHash, handler);
+          plugin->submit(request);
+        };
+      else if(method == "pause_torrent") {
+        DECODE_ARGUMENT(1, graceful, bool, decodeBoolean)
+        return [plugin, infoHash, graceful] (const request::SubroutineHandler & handler) {
+          request::PauseTorrent request(infoHash, graceful, handler);
+          plugin->submit(request);
+        };
+      } else if(method == "resume_torrent")
+        return [plugin, infoHash] (const request::SubroutineHandler & handler) {
+          request::ResumeTorrent request(infoHash, handler);
+          plugin->submit(request);
+        };
+      else if(method == "start_downloading") {
+        DECODE_ARGUMENT(1, contractTx, Coin::Transaction, joystream::node::transaction::decode)
+        DECODE_ARGUMENT(2, peerToStartDownloadInformationMap,
+                        protocol_session::PeerToStartDownloadInformationMap<libtorrent::peer_id>,
+                        joystream::node::PeerToStartDownloadInformationMap::decode)
+        return [plugin, infoHash, contractTx, peerToStartDownloadInformationMap] (const request::SubroutineHandler & handler) {
+          request::StartDownloading request(infoHash, contractTx, peerToStartDownloadInformationMap, handler);
+          plugin->submit(request);
+        };
+      } else if(method == "start_uploading") {
+        DECODE_ARGUMENT(1, peerId, libtorrent::peer_id, hashes::decodePeerId)
+        DECODE_ARGUMENT(2, buyerTerms, protocol_wire::BuyerTerms, joystream::node::buyer_terms::decode)
+        DECODE_ARGUMENT(3, contractSk, Coin::PrivateKey, joystream::node::private_key::decode)
+        DECODE_ARGUMENT(4, finalPkHash, Coin::PubKeyHash, joystream::node::pubkey_hash::decode)
+        return [plugin, infoHash, peerId, buyerTerms, contractSk, finalPkHash] (const request::SubroutineHandler & handler) {
+          request::StartUploading request(infoHash, peerId, buyerTerms, Coin::KeyPair(contractSk), finalPkHash, handler);
+          plugin->submit(request);
+        };
+      } else if(method == "set_libtorrent_interaction") {
+        DECODE_ARGUMENT(1, libtorrentInteraction, TorrentPlugin::LibtorrentInteraction, joystream::node::libtorrent_interaction::decode)
+        return [plugin, infoHash, libtorrentInteraction] (const request::SubroutineHandler & handler) {
+          request::SetLibtorrentInteraction request(infoHash, libtorrentInteraction, handler);
+          plugin->submit(request);
+        };
+      } else if(method == "dropPeer") {
+        DECODE_ARGUMENT(1, peerId, libtorrent::peer_id, hashes::decodePeerId)
+        return [plugin, infoHash, peerId] (const request::SubroutineHandler & handler) {
+          request::DropPeer request(infoHash, peerId, handler);
+          plugin->submit(request);
+        };
+      }
+
+      throw std::runtime_error("unsupported method " + method);
+    }
+
+    #undef DECODE_ARGUMENT
+  }
+
   /**
   /// This is what I would prefer, but does not build
   auto CreateGenericSubroutineHandler = std::bind(CreateSubroutineHandler<>,
@@ -12,11 +12,16 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <memory>
+
 namespace joystream {
 namespace extension {
   class Plugin;
 }
 namespace node {
+namespace PluginAlertEncoder {
+  class Encoder;
+}
 
 /**
  * @brief Binding for joystream extension.
@@ -35,6 +40,9 @@ private:
 
   boost::shared_ptr<joystream::extension::Plugin> _plugin;
 
+  // Encodes alerts of this plugin, and holds what javascript takes after a pop
+  std::shared_ptr<PluginAlertEncoder::Encoder> _encoder;
+
   Plugin(const boost::shared_ptr<joystream::extension::Plugin> & plugin);
 
   static Nan::Persistent<v8::Function> constructor;
@@ -58,6 +66,25 @@ private:
   static NAN_METHOD(StartUploading);
   static NAN_METHOD(SetLibtorrentInteraction);
   static NAN_METHOD(DropPeer);
+  static NAN_METHOD(SetAlertFilter);
+  static NAN_METHOD(SetAlertSubscriptions);
+  static NAN_METHOD(SetPaymentAlertBatching);
+  static NAN_METHOD(TakePaymentAlertBatch);
+  static NAN_METHOD(SetStatusUpdateDeltas);
+  static NAN_METHOD(TakeStatusDeltas);
+  static NAN_METHOD(SetPeerStatusBatching);
+  static NAN_METHOD(TakePeerStatusBatch);
+  static NAN_METHOD(SubmitBatch);
+  static NAN_METHOD(SetRequestResultCoalescing);
+  static NAN_METHOD(RunRequestResults);
+  static NAN_METHOD(TorrentSlot);
+  static NAN_METHOD(RecycleTorrentSlots);
+  static NAN_METHOD(AlertPopEnded);
+  static NAN_METHOD(SetAlertRouting);
+  static NAN_METHOD(TakeRoutedAlerts);
+  static NAN_METHOD(ConnectionRates);
+  static NAN_METHOD(SetPieceTracing);
+  static NAN_METHOD(TakePieceLatencySamples);
 
 };
 
@@ -8,7 +8,7 @@
 #include "PluginAlertEncoder.hpp"
 #include "libtorrent-node/alert.hpp"
 #include "libtorrent-node/endpoint.hpp"
-#include "libtorrent-node/peer_id.hpp"
+#include "Hashes.hpp"
 #include "libtorrent-node/utils.hpp"
 #include "RequestResult.hpp"
 #include "TorrentPluginStatus.hpp"
@@ -21,54 +21,299 @@
 #include "PrivateKey.hpp"
 #include "OutPoint.hpp"
 #include "PublicKey.hpp"
+#include "LazyAlert.hpp"
+#include "AlertTimestamp.hpp"
+#include "Tracing.hpp"
+#include "Metrics.hpp"
 
 #include <extension/extension.hpp>
 
-#define SET_JOYSTREAM_PLUGIN_ALERT_TYPE(o, name) SET_VAL(o, #name, Nan::New<v8::Number>(joystream::extension::alert::name::alert_type));
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#define SET_JOYSTREAM_PLUGIN_ALERT_TYPE(o, name) SET_VAL(o, #name, Nan::New<v8::Number>(joystream::extension::alert::name::alert_type)); \
+  encoders.push_back(EncoderInfo(static_cast<int>(joystream::extension::alert::name::alert_type), #name, &encodeAs<joystream::extension::alert::name>, \
+                                 std::is_base_of<libtorrent::torrent_alert, joystream::extension::alert::name>::value));
 
 namespace joystream {
 namespace node {
 namespace PluginAlertEncoder {
 
-  boost::optional<v8::Local<v8::Object>> alertEncoder(const libtorrent::alert *a) {
+  typedef v8::Local<v8::Object> (*TypeEncoder)(const libtorrent::alert * a);
+
+  template<class T>
+  v8::Local<v8::Object> encodeAs(const libtorrent::alert * a) {
+    return encode(static_cast<T const *>(a));
+  }
+
+  struct EncoderInfo {
+
+    EncoderInfo(int type, const char * name, TypeEncoder encoder, bool torrentAlert)
+      : type(type), name(name), encoder(encoder), torrentAlert(torrentAlert) {}
+
+    int type;
+    const char * name;
+    TypeEncoder encoder;
+    bool torrentAlert;
+  };
+
+  struct DispatchEntry {
+
+    DispatchEntry() : name(nullptr), encoder(nullptr), torrentAlert(false), category(0), encodeTime(nullptr) {}
 
-    #define ENCODE_PLUGIN_ALERT(name) if(joystream::extension::alert::name const * p = libtorrent::alert_cast<joystream::extension::alert::name>(a)) v = encode(p);
+    // Name of alert type
+    const char * name;
+
+    // Encoder for alert type, null if not a joystream alert
+    TypeEncoder encoder;
+
+    // Whether alert is a libtorrent::torrent_alert, which carries
+    // slot of torrent, and may be routed, see alert_routing
+    bool torrentAlert;
+
+    // AlertCategory of alert, 0 for alerts which are always delivered
+    uint32_t category;
+
+    // Time spent encoding or collecting alert
+    metrics::Histogram * encodeTime;
+  };
+
+  // Entry for each alert type in [firstAlertType, firstAlertType + dispatchTable.size()),
+  // built once by InitAlertTypes, and shared by encoders of all plugins
+  static std::vector<DispatchEntry> dispatchTable;
+  static int firstAlertType = 0;
+
+  static metrics::Counter & alertsPopped = metrics::counter("alerts_popped");
+  static metrics::Counter & alertsEncoded = metrics::counter("alerts_encoded");
+  static metrics::Counter & alertsCollected = metrics::counter("alerts_collected");
+  static metrics::Counter & alertPops = metrics::counter("alert_pops");
+  static metrics::Histogram & alertsPerPop = metrics::histogram("alerts_per_pop");
+
+  Encoder::Encoder()
+    : _options(dispatchTable.size())
+    , _subscriptions(AlertCategory::All)
+    , _alertRouting(false)
+    , _statusUpdateDeltas(false)
+    , _peerStatusBatching(false)
+    , _alertsInPop(0) {
+
+    optionsOf(joystream::extension::alert::SentPayment::alert_type).collector = Collector::PaymentAlertBatch;
+    optionsOf(joystream::extension::alert::ValidPaymentReceived::alert_type).collector = Collector::PaymentAlertBatch;
+    optionsOf(joystream::extension::alert::SendingPieceToBuyer::alert_type).collector = Collector::PaymentAlertBatch;
+    optionsOf(joystream::extension::alert::ValidPieceArrived::alert_type).collector = Collector::PaymentAlertBatch;
+    optionsOf(joystream::extension::alert::TorrentPluginStatusUpdateAlert::alert_type).collector = Collector::StatusDelta;
+    optionsOf(joystream::extension::alert::PeerPluginStatusUpdateAlert::alert_type).collector = Collector::PeerStatusBatch;
+    optionsOf(joystream::extension::alert::RequestResult::alert_type).collector = Collector::RequestResults;
+  }
+
+  Encoder::TypeOptions & Encoder::optionsOf(int type) {
+    return _options[type - firstAlertType];
+  }
+
+  // Alert is delivered if it passes both filter and subscriptions
+  void Encoder::updateDelivered() {
+
+    for(std::size_t i = 0;i < dispatchTable.size();i++)
+      _options[i].delivered = (_filteredTypes.empty() || _filteredTypes.count(firstAlertType + (int)i) > 0) &&
+                              (dispatchTable[i].category == 0 || (dispatchTable[i].category & _subscriptions) != 0);
+
+    // Request callbacks must always run
+    optionsOf(joystream::extension::alert::RequestResult::alert_type).delivered = true;
+  }
+
+  void Encoder::setAlertFilter(const std::set<int> & types) {
+    _filteredTypes = types;
+    updateDelivered();
+  }
+
+  void Encoder::setAlertSubscriptions(uint32_t mask) {
+    _subscriptions = mask;
+    updateDelivered();
+  }
+
+  boost::optional<v8::Local<v8::Object>> Encoder::operator()(const libtorrent::alert *a) {
 
     boost::optional<v8::Local<v8::Object>> v;
 
-    ENCODE_PLUGIN_ALERT(RequestResult)
-    else ENCODE_PLUGIN_ALERT(TorrentPluginStatusUpdateAlert)
-    else ENCODE_PLUGIN_ALERT(PeerPluginStatusUpdateAlert)
-    else ENCODE_PLUGIN_ALERT(ConnectionAddedToSession)
-    else ENCODE_PLUGIN_ALERT(ConnectionRemovedFromSession)
-    else ENCODE_PLUGIN_ALERT(SessionStarted)
-    else ENCODE_PLUGIN_ALERT(SessionPaused)
-    else ENCODE_PLUGIN_ALERT(SessionStopped)
-    else ENCODE_PLUGIN_ALERT(SessionToObserveMode)
-    else ENCODE_PLUGIN_ALERT(SessionToSellMode)
-    else ENCODE_PLUGIN_ALERT(SessionToBuyMode)
-    else ENCODE_PLUGIN_ALERT(ValidPaymentReceived)
-    else ENCODE_PLUGIN_ALERT(InvalidPaymentReceived)
-    else ENCODE_PLUGIN_ALERT(BuyerTermsUpdated)
-    else ENCODE_PLUGIN_ALERT(SellerTermsUpdated)
-    else ENCODE_PLUGIN_ALERT(ContractConstructed)
-    else ENCODE_PLUGIN_ALERT(SentPayment)
-    else ENCODE_PLUGIN_ALERT(LastPaymentReceived)
-    else ENCODE_PLUGIN_ALERT(InvalidPieceArrived)
-    else ENCODE_PLUGIN_ALERT(ValidPieceArrived)
-    else ENCODE_PLUGIN_ALERT(DownloadStarted)
-    else ENCODE_PLUGIN_ALERT(UploadStarted)
-    else ENCODE_PLUGIN_ALERT(SendingPieceToBuyer)
-    else ENCODE_PLUGIN_ALERT(PieceRequestedByBuyer)
-    else ENCODE_PLUGIN_ALERT(AnchorAnnounced)
+    torrentSlots.observe(a);
+
+    if(auto ended = connectionRates.observe(a))
+      pieceTracer.sample(static_cast<const libtorrent::peer_alert *>(a), *ended);
+
+    _alertsInPop++;
+
+    // Wraps around for types below first type
+    std::size_t i = (std::size_t)(a->type() - firstAlertType);
+
+    if(i < dispatchTable.size()) {
+
+      const DispatchEntry & entry = dispatchTable[i];
+      const TypeOptions & options = _options[i];
+
+      if(!entry.encoder || !options.delivered)
+        return v;
+
+      metrics::Timer timer(*entry.encodeTime);
+      tracing::Span span(entry.name, "encode");
+
+      if(options.collect) {
+        collect(options.collector, a);
+        alertsCollected.add();
+        return v;
+      }
+
+      v8::Local<v8::Object> o = entry.encoder(a);
+
+      alertsEncoded.add();
+
+      SET_NUMBER(o, "timestamp", alert_timestamp::encode(a));
+
+      if(entry.torrentAlert) {
+
+        int32_t slot = torrentSlots.slot(static_cast<const libtorrent::torrent_alert *>(a)->handle.info_hash());
+
+        if(slot != torrent_slots::None) {
+
+          SET_NUMBER(o, "torrentSlot", slot);
+
+          if(_alertRouting) {
+            routedAlerts.route(slot, o);
+            return v;
+          }
+        }
+      }
+
+      v = o;
+    }
 
     return v;
   }
 
+  void Encoder::collect(Collector collector, const libtorrent::alert * a) {
+
+    switch(collector) {
+      case Collector::PaymentAlertBatch: paymentAlerts.collect(a); break;
+      case Collector::StatusDelta: statusDeltas.collect(a); break;
+      case Collector::PeerStatusBatch: peerStatuses.collect(a); break;
+      case Collector::RequestResults: requestResults.collect(a); break;
+      case Collector::None: break;
+    }
+  }
+
+  void Encoder::popEnded() {
+
+    alertsPopped.add(_alertsInPop);
+    alertPops.add();
+    alertsPerPop.record(_alertsInPop);
+
+    _alertsInPop = 0;
+  }
+
+  void Encoder::setCollected(int type, bool collect) {
+    optionsOf(type).collect = collect;
+  }
+
+  void Encoder::setPaymentAlertBatching(bool enable) {
+    setCollected(joystream::extension::alert::SentPayment::alert_type, enable);
+    setCollected(joystream::extension::alert::ValidPaymentReceived::alert_type, enable);
+    setCollected(joystream::extension::alert::SendingPieceToBuyer::alert_type, enable);
+    setCollected(joystream::extension::alert::ValidPieceArrived::alert_type, enable);
+  }
+
+  // Deltas take precedence over batching of peer statuses
+  void Encoder::setPeerStatusCollector() {
+
+    TypeOptions & options = optionsOf(joystream::extension::alert::PeerPluginStatusUpdateAlert::alert_type);
+
+    options.collector = _statusUpdateDeltas ? Collector::StatusDelta : Collector::PeerStatusBatch;
+    options.collect = _statusUpdateDeltas || _peerStatusBatching;
+  }
+
+  void Encoder::setStatusUpdateDeltas(bool enable) {
+
+    _statusUpdateDeltas = enable;
+
+    setCollected(joystream::extension::alert::TorrentPluginStatusUpdateAlert::alert_type, enable);
+    setPeerStatusCollector();
+
+    // Next time deltas are enabled, first delivery is in full
+    if(!enable)
+      statusDeltas.reset();
+  }
+
+  void Encoder::setPeerStatusBatching(bool enable) {
+
+    _peerStatusBatching = enable;
+
+    setPeerStatusCollector();
+  }
+
+  void Encoder::setRequestResultCoalescing(bool enable) {
+    setCollected(joystream::extension::alert::RequestResult::alert_type, enable);
+  }
+
+  void Encoder::setAlertRouting(bool enable) {
+    _alertRouting = enable;
+  }
+
+  void InitDispatchTable(const std::vector<EncoderInfo> & encoders) {
+
+    int first = encoders.front().type;
+    int last = encoders.front().type;
+
+    for(auto & e : encoders) {
+      first = std::min(first, e.type);
+      last = std::max(last, e.type);
+    }
+
+    firstAlertType = first;
+    dispatchTable.assign(last - first + 1, DispatchEntry());
+
+    for(auto & e : encoders) {
+      dispatchTable[e.type - first].name = e.name;
+      dispatchTable[e.type - first].encoder = e.encoder;
+      dispatchTable[e.type - first].torrentAlert = e.torrentAlert;
+      dispatchTable[e.type - first].encodeTime = &metrics::histogram(std::string("alert_encode_ns.") + e.name);
+    }
+
+    // Categories
+    #define SET_CATEGORY(name, c) dispatchTable[joystream::extension::alert::name::alert_type - first].category = AlertCategory::c;
+
+    SET_CATEGORY(TorrentPluginStatusUpdateAlert, Status)
+    SET_CATEGORY(PeerPluginStatusUpdateAlert, Status)
+    SET_CATEGORY(ConnectionAddedToSession, Connection)
+    SET_CATEGORY(ConnectionRemovedFromSession, Connection)
+    SET_CATEGORY(SessionStarted, Session)
+    SET_CATEGORY(SessionPaused, Session)
+    SET_CATEGORY(SessionStopped, Session)
+    SET_CATEGORY(SessionToObserveMode, Session)
+    SET_CATEGORY(SessionToSellMode, Session)
+    SET_CATEGORY(SessionToBuyMode, Session)
+    SET_CATEGORY(BuyerTermsUpdated, Buying)
+    SET_CATEGORY(ContractConstructed, Buying)
+    SET_CATEGORY(SentPayment, Buying)
+    SET_CATEGORY(InvalidPieceArrived, Buying)
+    SET_CATEGORY(ValidPieceArrived, Buying)
+    SET_CATEGORY(DownloadStarted, Buying)
+    SET_CATEGORY(SellerTermsUpdated, Selling)
+    SET_CATEGORY(ValidPaymentReceived, Selling)
+    SET_CATEGORY(InvalidPaymentReceived, Selling)
+    SET_CATEGORY(LastPaymentReceived, Selling)
+    SET_CATEGORY(UploadStarted, Selling)
+    SET_CATEGORY(SendingPieceToBuyer, Selling)
+    SET_CATEGORY(PieceRequestedByBuyer, Selling)
+    SET_CATEGORY(AnchorAnnounced, Selling)
+
+    #undef SET_CATEGORY
+  }
+
   NAN_MODULE_INIT(InitAlertTypes) {
 
-    // Export extended alert types
+    // Export extended alert types, and collect their encoders
     v8::Local<v8::Object> object = Nan::New<v8::Object>();
+    std::vector<EncoderInfo> encoders;
 
     SET_JOYSTREAM_PLUGIN_ALERT_TYPE(object, RequestResult)
     SET_JOYSTREAM_PLUGIN_ALERT_TYPE(object, TorrentPluginStatusUpdateAlert)
@@ -98,6 +343,37 @@ namespace PluginAlertEncoder {
 
     SET_VAL(target, "AlertType", object);
 
+    v8::Local<v8::Object> categories = Nan::New<v8::Object>();
+
+    SET_NUMBER(categories, "Status", AlertCategory::Status);
+    SET_NUMBER(categories, "Connection", AlertCategory::Connection);
+    SET_NUMBER(categories, "Session", AlertCategory::Session);
+    SET_NUMBER(categories, "Buying", AlertCategory::Buying);
+    SET_NUMBER(categories, "Selling", AlertCategory::Selling);
+    SET_NUMBER(categories, "All", AlertCategory::All);
+
+    SET_VAL(target, "AlertCategory", categories);
+
+    InitDispatchTable(encoders);
+    InitLazyAlertTypes();
+  }
+
+  void InitLazyAlertTypes() {
+
+    #define DEFINE_LAZY_TORRENT_ALERT(name, ...) LazyAlert::DefineType(joystream::extension::alert::name::alert_type, LazyAlert::TorrentAlertFields({__VA_ARGS__}));
+    #define DEFINE_LAZY_PEER_ALERT(name, ...) LazyAlert::DefineType(joystream::extension::alert::name::alert_type, LazyAlert::PeerAlertFields({__VA_ARGS__}));
+
+    // Field order must match encoders below
+    DEFINE_LAZY_PEER_ALERT(ConnectionAddedToSession, "status")
+    DEFINE_LAZY_TORRENT_ALERT(SessionToSellMode, "terms")
+    DEFINE_LAZY_TORRENT_ALERT(SessionToBuyMode, "terms")
+    DEFINE_LAZY_TORRENT_ALERT(BuyerTermsUpdated, "terms")
+    DEFINE_LAZY_TORRENT_ALERT(SellerTermsUpdated, "terms")
+    DEFINE_LAZY_TORRENT_ALERT(ContractConstructed, "tx")
+    DEFINE_LAZY_PEER_ALERT(LastPaymentReceived, "settlementTx")
+    DEFINE_LAZY_TORRENT_ALERT(DownloadStarted, "contractTx")
+    DEFINE_LAZY_TORRENT_ALERT(UploadStarted, "pid", "terms", "contractPrivateKey", "finalPkHash")
+    DEFINE_LAZY_TORRENT_ALERT(AnchorAnnounced, "pid", "value", "outpoint", "contractPk", "finalPkHash")
   }
 
     v8::Local<v8::Object> encode(joystream::extension::alert::RequestResult const * p) {
@@ -134,11 +410,11 @@ namespace PluginAlertEncoder {
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::ConnectionAddedToSession const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::peer_alert const *>(p));
+    auto status = p->status;
 
-    SET_VAL(v, "status", connection::encode(p->status));
-
-    return v;
+    return LazyAlert::NewInstance(p, LazyAlert::PeerAlertEncoders(p, {
+      [status]() -> v8::Local<v8::Value> { return connection::encode(status); }
+    }));
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::ConnectionRemovedFromSession const * p) {
@@ -162,19 +438,19 @@ namespace PluginAlertEncoder {
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::SessionToSellMode const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::torrent_alert const *>(p));
+    auto terms = p->terms;
 
-    SET_VAL(v, "terms", seller_terms::encode(p->terms));
-
-    return v;
+    return LazyAlert::NewInstance(p, LazyAlert::TorrentAlertEncoders(p, {
+      [terms]() -> v8::Local<v8::Value> { return seller_terms::encode(terms); }
+    }));
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::SessionToBuyMode const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::torrent_alert const *>(p));
-
-    SET_VAL(v, "terms", buyer_terms::encode(p->terms));
+    auto terms = p->terms;
 
-    return v;
+    return LazyAlert::NewInstance(p, LazyAlert::TorrentAlertEncoders(p, {
+      [terms]() -> v8::Local<v8::Value> { return buyer_terms::encode(terms); }
+    }));
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::ValidPaymentReceived const * p) {
@@ -198,27 +474,27 @@ namespace PluginAlertEncoder {
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::BuyerTermsUpdated const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::torrent_alert const *>(p));
+    auto terms = p->terms;
 
-    SET_VAL(v, "terms", buyer_terms::encode(p->terms));
-
-    return v;
+    return LazyAlert::NewInstance(p, LazyAlert::TorrentAlertEncoders(p, {
+      [terms]() -> v8::Local<v8::Value> { return buyer_terms::encode(terms); }
+    }));
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::SellerTermsUpdated const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::torrent_alert const *>(p));
-
-    SET_VAL(v, "terms", seller_terms::encode(p->terms));
+    auto terms = p->terms;
 
-    return v;
+    return LazyAlert::NewInstance(p, LazyAlert::TorrentAlertEncoders(p, {
+      [terms]() -> v8::Local<v8::Value> { return seller_terms::encode(terms); }
+    }));
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::ContractConstructed const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::torrent_alert const *>(p));
+    auto tx = p->tx;
 
-    SET_VAL(v, "tx", transaction::encode(p->tx));
-
-    return v;
+    return LazyAlert::NewInstance(p, LazyAlert::TorrentAlertEncoders(p, {
+      [tx]() -> v8::Local<v8::Value> { return transaction::encode(tx); }
+    }));
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::SentPayment const * p) {
@@ -233,16 +509,19 @@ namespace PluginAlertEncoder {
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::LastPaymentReceived const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::peer_alert const *>(p));
-
-    try {
-      // Try to generate the settlement transaction
-      SET_VAL(v, "settlementTx", transaction::encode(p->payee.lastPaymentTransaction()));
-    } catch (std::exception &e) {
-      // if funds did not cover payment
-    }
-
-    return v;
+    auto payee = p->payee;
+
+    return LazyAlert::NewInstance(p, LazyAlert::PeerAlertEncoders(p, {
+      [payee]() -> v8::Local<v8::Value> {
+        try {
+          // Try to generate the settlement transaction
+          return transaction::encode(payee.lastPaymentTransaction());
+        } catch (std::exception &e) {
+          // if funds did not cover payment
+          return Nan::Undefined();
+        }
+      }
+    }));
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::InvalidPieceArrived const * p) {
@@ -262,23 +541,26 @@ namespace PluginAlertEncoder {
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::DownloadStarted const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::torrent_alert const *>(p));
-
-    SET_VAL(v, "contractTx", transaction::encode(p->contractTx));
-    //SET_VAL(v, "peerToStartDownloadInformationMap", encode(p->peerToStartDownloadInformationMap));
+    auto contractTx = p->contractTx;
 
-    return v;
+    return LazyAlert::NewInstance(p, LazyAlert::TorrentAlertEncoders(p, {
+      [contractTx]() -> v8::Local<v8::Value> { return transaction::encode(contractTx); }
+      //peerToStartDownloadInformationMap
+    }));
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::UploadStarted const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::torrent_alert const *>(p));
-
-    SET_VAL(v, "pid", libtorrent::node::peer_id::encode(p->peerId));
-    SET_VAL(v, "terms", buyer_terms::encode(p->terms));
-    SET_VAL(v, "contractPrivateKey", private_key::encode(p->contractKeyPair.sk()));
-    SET_VAL(v, "finalPkHash", pubkey_hash::encode(p->finalPkHash));
-
-    return v;
+    auto peerId = p->peerId;
+    auto terms = p->terms;
+    auto contractSk = p->contractKeyPair.sk();
+    auto finalPkHash = p->finalPkHash;
+
+    return LazyAlert::NewInstance(p, LazyAlert::TorrentAlertEncoders(p, {
+      [peerId]() -> v8::Local<v8::Value> { return hashes::encodePeerId(peerId); },
+      [terms]() -> v8::Local<v8::Value> { return buyer_terms::encode(terms); },
+      [contractSk]() -> v8::Local<v8::Value> { return private_key::encode(contractSk); },
+      [finalPkHash]() -> v8::Local<v8::Value> { return pubkey_hash::encode(finalPkHash); }
+    }));
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::SendingPieceToBuyer const * p) {
@@ -299,15 +581,19 @@ namespace PluginAlertEncoder {
   }
 
   v8::Local<v8::Object> encode(joystream::extension::alert::AnchorAnnounced const * p) {
-    auto v = libtorrent::node::alert_types::encode(static_cast<libtorrent::torrent_alert const *>(p));
-
-    SET_VAL(v, "pid", libtorrent::node::peer_id::encode(p->_peerId));
-    SET_NUMBER(v, "value", p->_value);
-    SET_VAL(v, "outpoint", outpoint::encode(p->_anchor));
-    SET_VAL(v, "contractPk", public_key::encode(p->_contractPk));
-    SET_VAL(v, "finalPkHash", pubkey_hash::encode(p->_finalPkHash));
-
-    return v;
+    auto peerId = p->_peerId;
+    auto value = p->_value;
+    auto anchor = p->_anchor;
+    auto contractPk = p->_contractPk;
+    auto finalPkHash = p->_finalPkHash;
+
+    return LazyAlert::NewInstance(p, LazyAlert::TorrentAlertEncoders(p, {
+      [peerId]() -> v8::Local<v8::Value> { return hashes::encodePeerId(peerId); },
+      [value]() -> v8::Local<v8::Value> { return Nan::New<v8::Number>(value); },
+      [anchor]() -> v8::Local<v8::Value> { return outpoint::encode(anchor); },
+      [contractPk]() -> v8::Local<v8::Value> { return public_key::encode(contractPk); },
+      [finalPkHash]() -> v8::Local<v8::Value> { return pubkey_hash::encode(finalPkHash); }
+    }));
   }
 
 }
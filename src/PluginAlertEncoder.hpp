@@ -11,6 +11,18 @@
 #include <nan.h>
 
 #include "libtorrent-node/common.hpp"
+#include "TorrentSlots.hpp"
+#include "AlertRouting.hpp"
+#include "PaymentAlertBatch.hpp"
+#include "StatusDelta.hpp"
+#include "PeerStatusBatch.hpp"
+#include "RequestResult.hpp"
+#include "ConnectionRates.hpp"
+#include "PieceTracer.hpp"
+
+#include <cstdint>
+#include <set>
+#include <vector>
 
 namespace joystream {
   struct alert;
@@ -46,9 +58,147 @@ namespace alert {
 namespace node {
 namespace PluginAlertEncoder {
 
+  // Groups of joystream alerts which can be subscribed to, RequestResult
+  // belongs to no group and is always delivered
+  namespace AlertCategory {
+    enum : uint32_t {
+      Status = 1,     // TorrentPluginStatusUpdateAlert, PeerPluginStatusUpdateAlert
+      Connection = 2, // ConnectionAddedToSession, ConnectionRemovedFromSession
+      Session = 4,    // Session* mode and state changes
+      Buying = 8,     // BuyerTermsUpdated, ContractConstructed, SentPayment, InvalidPieceArrived, ValidPieceArrived, DownloadStarted
+      Selling = 16,   // SellerTermsUpdated, *PaymentReceived, UploadStarted, SendingPieceToBuyer, PieceRequestedByBuyer, AnchorAnnounced
+      All = 31
+    };
+  }
+
+  // Exports "AlertType" and "AlertCategory"
   NAN_MODULE_INIT(InitAlertTypes);
 
-  boost::optional<v8::Local<v8::Object>> alertEncoder(const libtorrent::alert *a);
+  // Defines lazy handle types, called by InitAlertTypes
+  void InitLazyAlertTypes();
+
+  /**
+   * @brief Alert encoder of one plugin, along with the options set on the plugin,
+   * and state fed by every popped alert, which javascript reads or takes after a pop.
+   * Only ever used on node thread.
+   */
+  class Encoder {
+
+  public:
+
+    Encoder();
+
+    // Encodes alert, unless it is dropped, collected or routed, see options below
+    boost::optional<v8::Local<v8::Object>> operator()(const libtorrent::alert * a);
+
+    /* @brief Restricts which joystream alert types are encoded, all other
+     * joystream alerts never reach javascript. RequestResult is always encoded.
+     *
+     * @param types alert types to encode, an empty set means all types
+     */
+    void setAlertFilter(const std::set<int> & types);
+
+    /* @brief Restricts joystream alerts to those in subscribed categories,
+     * alerts outside are dropped before being encoded or collected.
+     * Applies on top of setAlertFilter.
+     *
+     * @param mask AlertCategory values or'ed together
+     */
+    void setAlertSubscriptions(uint32_t mask);
+
+    /* @brief When enabled, SentPayment, ValidPaymentReceived, SendingPieceToBuyer and
+     * ValidPieceArrived alerts are collected into a columnar batch rather than encoded
+     * one object at a time, see paymentAlerts.
+     *
+     * @param enable whether to batch payment alerts
+     */
+    void setPaymentAlertBatching(bool enable);
+
+    /* @brief When enabled, TorrentPluginStatusUpdateAlert and PeerPluginStatusUpdateAlert
+     * are diffed against previous statuses rather than encoded, see statusDeltas.
+     *
+     * @param enable whether to deliver status updates as deltas
+     */
+    void setStatusUpdateDeltas(bool enable);
+
+    /* @brief When enabled, PeerPluginStatusUpdateAlert of all torrents are merged
+     * rather than encoded one alert at a time, see peerStatuses.
+     * Has no effect while status update deltas are enabled.
+     *
+     * @param enable whether to batch peer status updates
+     */
+    void setPeerStatusBatching(bool enable);
+
+    /* @brief When enabled, RequestResult alerts are queued natively rather than
+     * encoded, and their callbacks are run together by requestResults.
+     *
+     * @param enable whether to coalesce request results
+     */
+    void setRequestResultCoalescing(bool enable);
+
+    /* @brief When enabled, joystream alerts about a torrent with a slot are
+     * grouped by torrent rather than returned, see routedAlerts.
+     *
+     * @param enable whether to route alerts
+     */
+    void setAlertRouting(bool enable);
+
+    /* @brief Records number of alerts encoded since last call as one pop,
+     * called once after all alerts of a pop have been encoded.
+     */
+    void popEnded();
+
+    // Fed by popped alerts, read or taken by javascript after a pop
+    torrent_slots::Slots torrentSlots;
+    alert_routing::Groups routedAlerts;
+    payment_alert_batch::Batch paymentAlerts;
+    status_delta::Deltas statusDeltas;
+    peer_status_batch::Batch peerStatuses;
+    request_results::Queue requestResults;
+    connection_rates::Rates connectionRates;
+    piece_tracer::Tracer pieceTracer;
+
+  private:
+
+    // Where alerts are accumulated natively rather than encoded
+    enum class Collector { None, PaymentAlertBatch, StatusDelta, PeerStatusBatch, RequestResults };
+
+    struct TypeOptions {
+
+      TypeOptions() : delivered(true), collector(Collector::None), collect(false) {}
+
+      // Whether alert passes filter and subscriptions
+      bool delivered;
+
+      // Alternative to encoding, taken by javascript after alerts have been popped
+      Collector collector;
+
+      // Whether collector is used rather than encoder
+      bool collect;
+    };
+
+    TypeOptions & optionsOf(int type);
+
+    void updateDelivered();
+
+    void setCollected(int type, bool collect);
+
+    void setPeerStatusCollector();
+
+    void collect(Collector collector, const libtorrent::alert * a);
+
+    // Options of each alert type in dispatch table, by same index
+    std::vector<TypeOptions> _options;
+
+    std::set<int> _filteredTypes;
+    uint32_t _subscriptions;
+    bool _alertRouting;
+    bool _statusUpdateDeltas;
+    bool _peerStatusBatching;
+
+    // Alerts seen since end of last pop, see popEnded
+    uint64_t _alertsInPop;
+  };
 
   v8::Local<v8::Object> encode(extension::alert::RequestResult const * p);
   v8::Local<v8::Object> encode(extension::alert::TorrentPluginStatusUpdateAlert const * p);
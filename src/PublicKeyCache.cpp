@@ -0,0 +1,262 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "PublicKeyCache.hpp"
+#include "libtorrent-node/utils.hpp"
+
+#include <common/PrivateKey.hpp>
+#include <common/PublicKey.hpp>
+
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace joystream {
+namespace node {
+namespace public_key_cache {
+
+  namespace {
+
+    // Keeps locked memory below the common 64KB RLIMIT_MEMLOCK
+    const uint32_t Capacity = 512;
+
+    const std::size_t CompressedPublicKeySize = 33;
+
+    const uint32_t None = Capacity;
+
+    struct Entry {
+      unsigned char digest[SHA256_DIGEST_LENGTH];
+      unsigned char pk[CompressedPublicKeySize];
+    };
+
+    void * allocateLocked(std::size_t size, bool & locked) {
+
+    #ifdef _WIN32
+      void * p = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+
+      locked = p != nullptr && VirtualLock(p, size);
+    #else
+      void * p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if(p == MAP_FAILED)
+        p = nullptr;
+
+      locked = p != nullptr && mlock(p, size) == 0;
+
+      #ifdef MADV_DONTDUMP
+      if(p != nullptr)
+        madvise(p, size, MADV_DONTDUMP);
+      #endif
+    #endif
+
+      return p;
+    }
+
+    class Cache {
+
+    public:
+
+      Cache()
+        : _locked(false)
+        , _entries(static_cast<Entry *>(allocateLocked(Capacity * sizeof(Entry), _locked)))
+        , _size(0)
+        , _head(None)
+        , _tail(None)
+        , _prev(Capacity, None)
+        , _next(Capacity, None)
+        , _hits(0)
+        , _misses(0)
+        , _evictions(0) {
+      }
+
+      // Copies cached public key of digest into pk, if any
+      bool lookup(const unsigned char * digest, std::vector<unsigned char> & pk) {
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto it = _index.find(prefix(digest));
+
+        if(it == _index.end() || std::memcmp(_entries[it->second].digest, digest, SHA256_DIGEST_LENGTH) != 0) {
+          _misses++;
+          return false;
+        }
+
+        uint32_t i = it->second;
+
+        pk.assign(_entries[i].pk, _entries[i].pk + CompressedPublicKeySize);
+
+        // Most recently used first
+        unlink(i);
+        pushFront(i);
+
+        _hits++;
+
+        return true;
+      }
+
+      void insert(const unsigned char * digest, const std::vector<unsigned char> & pk) {
+
+        if(_entries == nullptr || pk.size() != CompressedPublicKeySize)
+          return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        uint32_t i;
+        auto it = _index.find(prefix(digest));
+
+        if(it != _index.end()) {
+
+          // Same key inserted concurrently, or a prefix collision, either way slot is reused
+          i = it->second;
+          unlink(i);
+
+        } else if(_size < Capacity) {
+
+          i = _size++;
+
+        } else {
+
+          i = _tail;
+          unlink(i);
+
+          _index.erase(prefix(_entries[i].digest));
+          _evictions++;
+        }
+
+        OPENSSL_cleanse(&_entries[i], sizeof(Entry));
+
+        std::memcpy(_entries[i].digest, digest, SHA256_DIGEST_LENGTH);
+        std::memcpy(_entries[i].pk, pk.data(), CompressedPublicKeySize);
+
+        _index[prefix(digest)] = i;
+        pushFront(i);
+      }
+
+      v8::Local<v8::Object> encodeStats() {
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+        SET_NUMBER(o, "hits", (double)_hits);
+        SET_NUMBER(o, "misses", (double)_misses);
+        SET_NUMBER(o, "evictions", (double)_evictions);
+        SET_NUMBER(o, "size", _size);
+        SET_NUMBER(o, "capacity", _entries == nullptr ? 0 : Capacity);
+        SET_BOOL(o, "locked", _locked);
+
+        return o;
+      }
+
+    private:
+
+      // Index is keyed by a prefix of the digest, so that full digests
+      // are only ever stored in locked memory
+      static uint64_t prefix(const unsigned char * digest) {
+        uint64_t p;
+        std::memcpy(&p, digest, sizeof(p));
+        return p;
+      }
+
+      void unlink(uint32_t i) {
+
+        if(_prev[i] != None)
+          _next[_prev[i]] = _next[i];
+        else if(_head == i)
+          _head = _next[i];
+
+        if(_next[i] != None)
+          _prev[_next[i]] = _prev[i];
+        else if(_tail == i)
+          _tail = _prev[i];
+
+        _prev[i] = _next[i] = None;
+      }
+
+      void pushFront(uint32_t i) {
+
+        _next[i] = _head;
+
+        if(_head != None)
+          _prev[_head] = i;
+
+        _head = i;
+
+        if(_tail == None)
+          _tail = i;
+      }
+
+      std::mutex _mutex;
+
+      bool _locked;
+
+      // Capacity entries in locked memory, null if allocation failed,
+      // lives as long as the process
+      Entry * _entries;
+
+      uint32_t _size;
+
+      // Recency list, most recent first
+      uint32_t _head, _tail;
+      std::vector<uint32_t> _prev, _next;
+
+      std::unordered_map<uint64_t, uint32_t> _index;
+
+      uint64_t _hits, _misses, _evictions;
+    };
+
+    Cache & cache() {
+      static Cache c;
+      return c;
+    }
+
+  }
+
+  Coin::PublicKey derive(const Coin::PrivateKey & sk) {
+
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+
+    {
+      std::vector<unsigned char> raw = sk.toRawVector();
+
+      SHA256(raw.data(), raw.size(), digest);
+
+      OPENSSL_cleanse(raw.data(), raw.size());
+    }
+
+    std::vector<unsigned char> pk;
+
+    if(cache().lookup(digest, pk)) {
+      OPENSSL_cleanse(digest, sizeof(digest));
+      return Coin::PublicKey::fromCompressedRaw(pk);
+    }
+
+    Coin::PublicKey derived = sk.toPublicKey();
+
+    cache().insert(digest, derived.toCompressedRawVector());
+
+    OPENSSL_cleanse(digest, sizeof(digest));
+
+    return derived;
+  }
+
+  NAN_METHOD(Stats) {
+    RETURN(cache().encodeStats())
+  }
+
+}
+}
+}
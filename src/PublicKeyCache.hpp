@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_PUBLIC_KEY_CACHE_HPP
+#define JOYSTREAM_NODE_PUBLIC_KEY_CACHE_HPP
+
+#include <nan.h>
+
+namespace Coin {
+  class PrivateKey;
+  class PublicKey;
+}
+
+namespace joystream {
+namespace node {
+namespace public_key_cache {
+
+  /*
+   * Bounded least recently used cache of public keys derived from private keys,
+   * as the same keys are used across many channels. Entries are keyed by the
+   * SHA-256 digest of the private key, never the key itself, and both digests
+   * and public keys live in memory which is locked against swapping
+   * and wiped on eviction. Safe to use from any thread.
+   */
+
+  /* @brief Public key of private key, only derived when not cached
+   * @param {const Coin::PrivateKey&} sk
+   * @return {Coin::PublicKey}
+   */
+  Coin::PublicKey derive(const Coin::PrivateKey & sk);
+
+  /* @brief Creates javascript representation of cache counters
+   * @return {v8::Local<v8::Object>} o where
+   *
+   * {Number} o.hits - derivations avoided
+   * {Number} o.misses - derivations made
+   * {Number} o.evictions - entries evicted to make room
+   * {Number} o.size - entries currently cached
+   * {Number} o.capacity - maximum number of entries
+   * {Boolean} o.locked - whether cache memory could be locked, when
+   *   it could not even be allocated, nothing is cached
+   */
+  NAN_METHOD(Stats);
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_PUBLIC_KEY_CACHE_HPP
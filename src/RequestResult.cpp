@@ -8,6 +8,7 @@
 #include "RequestResult.hpp"
 #include "detail/UnhandledCallbackException.hpp"
 #include "libtorrent-node/utils.hpp"
+#include "Tracing.hpp"
 
 #define UNWRAP_THIS(var) RequestResult * var = Nan::ObjectWrap::Unwrap<RequestResult>(info.This());
 
@@ -68,6 +69,8 @@ namespace node {
 
    UNWRAP_THIS(requestResult)
 
+   tracing::Span span("RequestResult::Run", "callback");
+
     // Make callback, and catch any unhandled exceptions
     // the developer may have introduced. This is here to
     // prevent weird stack corruption we were seeing, which made
@@ -118,5 +121,31 @@ NAN_GETTER(RequestResult::Type) {
    RETURN(category)
  }
 
+namespace request_results {
+
+  void Queue::collect(const libtorrent::alert * a) {
+
+    if(auto p = libtorrent::alert_cast<extension::alert::RequestResult>(a))
+      _pending.push_back(p->loadedCallback);
+  }
+
+  void Queue::run() {
+
+    tracing::Span span("request_results::run", "callback");
+
+    Nan::HandleScope scope;
+
+    while(!_pending.empty()) {
+
+      // Popped before running, so a throwing callback is not run again
+      extension::alert::LoadedCallback callback = _pending.front();
+      _pending.pop_front();
+
+      callback();
+    }
+  }
+
+}
+
 }
 }
@@ -12,6 +12,12 @@
 
 #include <extension/extension.hpp> // extension::alert::LoadedCallback
 
+#include <deque>
+
+namespace libtorrent {
+  class alert;
+}
+
 namespace joystream {
 namespace node {
 
@@ -45,6 +51,40 @@ private:
   static NAN_GETTER(Category);
 };
 
+namespace request_results {
+
+  /*
+   * Coalesced delivery of RequestResult alerts.
+   *
+   * Rather than wrapping each result in a RequestResult object which javascript
+   * runs, the callbacks of all results are queued, and all run in one call
+   * after alerts have been popped.
+   */
+
+  class Queue {
+
+  public:
+
+    /* @brief Queues callback of result
+     *
+     * @param a alert, RequestResult
+     */
+    void collect(const libtorrent::alert * a);
+
+    /* @brief Runs queued callbacks in order, in one handle scope.
+     * If a callback throws, remaining callbacks stay queued for next run.
+     *
+     * @throws detail::UnhandledCallbackException if callback throws
+     */
+    void run();
+
+  private:
+
+    std::deque<extension::alert::LoadedCallback> _pending;
+  };
+
+}
+
 }
 }
 
@@ -6,6 +6,7 @@
  */
 
 #include "SellerTerms.hpp"
+#include "ObjectShape.hpp"
 #include "libtorrent-node/utils.hpp"
 
 #include <protocol_wire/protocol_wire.hpp>
@@ -20,15 +21,19 @@ namespace joystream {
 namespace node {
 namespace seller_terms {
 
+enum Key { MinPrice, MinLock, MaxNumberOfSellers, MinContractFeePerKb, SettlementFee };
+
 v8::Local<v8::Value> encode(const protocol_wire::SellerTerms & terms) {
 
-  v8::Local<v8::Object> o = Nan::New<v8::Object>();
+  static const ObjectShape shape({MIN_PRICE_KEY, MIN_LOCK_KEY, MAX_NUMBER_OF_SELLERS_KEY, MIN_CONTRACT_FEE_PER_KB_KEY, SETTLEMENT_FEE_KEY});
+
+  v8::Local<v8::Object> o = shape.NewInstance();
 
-  SET_NUMBER(o, MIN_PRICE_KEY, terms.minPrice());
-  SET_UINT32(o, MIN_LOCK_KEY, terms.minLock());
-  SET_UINT32(o, MAX_NUMBER_OF_SELLERS_KEY, terms.maxSellers());
-  SET_NUMBER(o, MIN_CONTRACT_FEE_PER_KB_KEY, terms.minContractFeePerKb());
-  SET_NUMBER(o, SETTLEMENT_FEE_KEY, terms.settlementFee());
+  shape.Set(o, MinPrice, Nan::New<v8::Number>(terms.minPrice()));
+  shape.Set(o, MinLock, Nan::New<v8::Uint32>(terms.minLock()));
+  shape.Set(o, MaxNumberOfSellers, Nan::New<v8::Uint32>(terms.maxSellers()));
+  shape.Set(o, MinContractFeePerKb, Nan::New<v8::Number>(terms.minContractFeePerKb()));
+  shape.Set(o, SettlementFee, Nan::New<v8::Number>(terms.settlementFee()));
 
   return o;
 }
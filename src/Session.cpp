@@ -9,6 +9,7 @@
 #include "libtorrent-node/utils.hpp"
 #include "SellerTerms.hpp"
 #include "BuyerTerms.hpp"
+#include "ObjectShape.hpp"
 #include <protocol_session/protocol_session.hpp>
 
 namespace joystream {
@@ -123,19 +124,26 @@ v8::Local<v8::Object> encode(const protocol_session::status::Buying<libtorrent::
   return o;
 }
 
+namespace session_key {
+  enum { Mode, State, Selling, Buying };
+}
+
 v8::Local<v8::Object> encode(const protocol_session::status::Session<libtorrent::peer_id> & s) {
 
-  v8::Local<v8::Object> o = Nan::New<v8::Object>();
+  // selling and buying are only present in corresponding mode
+  static const ObjectShape shape({"mode", "state", "selling", "buying"}, 2);
+
+  v8::Local<v8::Object> o = shape.NewInstance();
 
-  SET_VAL(o, "mode", encode(s.mode));
-  SET_VAL(o, "state", encode(s.state));
+  shape.Set(o, session_key::Mode, encode(s.mode));
+  shape.Set(o, session_key::State, encode(s.state));
 
   // Adding a tiny bit of safety here
 
   if(s.mode == protocol_session::SessionMode::selling)
-    SET_VAL(o, "selling", encode(s.selling));
+    shape.Set(o, session_key::Selling, encode(s.selling));
   else if(s.mode == protocol_session::SessionMode::buying)
-    SET_VAL(o, "buying", encode(s.buying));
+    shape.Set(o, session_key::Buying, encode(s.buying));
 
   return o;
 }
@@ -11,7 +11,7 @@
 #include "PubKeyHash.hpp"
 #include <extension/Common.hpp> //std::hash<endpoint> specialization
 #include "libtorrent-node/endpoint.hpp"
-#include "libtorrent-node/peer_id.hpp"
+#include "Hashes.hpp"
 #include "libtorrent-node/utils.hpp"
 
 #define SELLER_TERMS_KEY "sellerTerms"
@@ -68,7 +68,7 @@ namespace PeerToStartDownloadInformationMap {
 protocol_session::PeerToStartDownloadInformationMap<libtorrent::peer_id> decode(const v8::Local<v8::Value> & v) {
 
   return std_lib_utils::decode<libtorrent::peer_id, protocol_session::StartDownloadConnectionInformation>(v,
-                                                                                                             &libtorrent::node::peer_id::decode,
+                                                                                                             &hashes::decodePeerId,
                                                                                                              &joystream::node::StartDownloadConnectionInformation::decode);
 }
 
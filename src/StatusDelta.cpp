@@ -0,0 +1,372 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "StatusDelta.hpp"
+#include "TorrentPluginStatus.hpp"
+#include "PeerPluginStatus.hpp"
+#include "BEPSupportStatus.hpp"
+#include "Connection.hpp"
+#include "libtorrent-node/utils.hpp"
+#include "Hashes.hpp"
+
+#include <extension/extension.hpp>
+
+namespace joystream {
+namespace node {
+namespace status_delta {
+
+  namespace {
+
+    // Fields of peer status which are compared
+    enum PeerField : uint32_t {
+      InnerState = 1,
+      BEPSupport = 2,
+      Payor = 4,
+      Payee = 8,
+      AnnouncedModeAndTerms = 16,
+      Connection = 32 // connection came or went, all connection fields are delivered
+    };
+
+    void append(std::vector<unsigned char> & raw, const std::vector<unsigned char> & field) {
+      raw.insert(raw.end(), field.begin(), field.end());
+    }
+
+    void setPending(TorrentPeers & t, const extension::status::PeerPlugin & s, uint32_t changed, bool added) {
+
+      auto it = t.pending.find(s.peerId);
+
+      if(it == t.pending.end())
+        t.pending.insert(std::make_pair(s.peerId, PendingPeer(s, changed, added)));
+      else {
+        it->second.status = s;
+        it->second.changed |= changed;
+      }
+    }
+
+    v8::Local<v8::Object> encodeChanged(const PendingPeer & p) {
+
+      v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+      const extension::status::PeerPlugin & s = p.status;
+
+      SET_VAL(o, "pid", hashes::encodePeerId(s.peerId));
+
+      if(p.changed & BEPSupport) {
+        SET_VAL(o, "peerBEP10SupportStatus", bep_support_status::encode(s.peerBEP10SupportStatus));
+        SET_VAL(o, "peerBitSwaprBEPSupportStatus", bep_support_status::encode(s.peerBitSwaprBEPSupportStatus));
+      }
+
+      if(!s.connection) {
+
+        if(p.changed & Connection)
+          SET_VAL(o, "connection", Nan::Null());
+
+        return o;
+      }
+
+      const auto & c = s.connection.get();
+
+      if(p.changed & Connection) {
+        SET_VAL(o, "connection", connection::encode(c));
+        return o;
+      }
+
+      if(p.changed & InnerState)
+        SET_VAL(o, "innerState", connection::encode(c.machine.innerStateTypeIndex));
+
+      if(p.changed & Payor)
+        SET_VAL(o, "payor", connection::encode(c.machine.payor));
+
+      if(p.changed & Payee)
+        SET_VAL(o, "payee", connection::encode(c.machine.payee));
+
+      if(p.changed & AnnouncedModeAndTerms)
+        SET_VAL(o, "announcedModeAndTermsFromPeer", connection::encode(c.machine.announcedModeAndTermsFromPeer));
+
+      return o;
+    }
+
+    v8::Local<v8::Object> encode(const libtorrent::sha1_hash & infoHash, const TorrentPeers & t) {
+
+      v8::Local<v8::Object> o = Nan::New<v8::Object>();
+      v8::Local<v8::Array> added = Nan::New<v8::Array>();
+      v8::Local<v8::Array> changed = Nan::New<v8::Array>();
+      v8::Local<v8::Array> removed = Nan::New<v8::Array>();
+
+      for(auto & m : t.pending) {
+        if(m.second.added)
+          added->Set(added->Length(), peer_plugin_status::encode(m.second.status));
+        else
+          changed->Set(changed->Length(), encodeChanged(m.second));
+      }
+
+      for(auto & pid : t.removed)
+        removed->Set(removed->Length(), hashes::encodePeerId(pid));
+
+      SET_VAL(o, "infoHash", hashes::encodeInfoHash(infoHash));
+      SET_VAL(o, "added", added);
+      SET_VAL(o, "changed", changed);
+      SET_VAL(o, "removed", removed);
+
+      return o;
+    }
+
+  }
+
+  PeerFingerprint::PeerFingerprint(const extension::status::PeerPlugin & s)
+    : bep10(static_cast<int>(s.peerBEP10SupportStatus))
+    , bitSwapr(static_cast<int>(s.peerBitSwaprBEPSupportStatus))
+    , hasConnection(s.connection.is_initialized())
+    , innerState(0)
+    , payor({{0, 0, 0, 0, 0, 0}})
+    , payee({{0, 0, 0, 0, 0, 0}})
+    , modeAnnounced(0)
+    , announcedTerms({{0, 0, 0, 0, 0, 0}}) {
+
+    if(!hasConnection)
+      return;
+
+    const auto & machine = s.connection.get().machine;
+
+    innerState = connection::innerStateIndex(machine.innerStateTypeIndex);
+
+    // Same fields as connection::encode of payor and payee
+    const auto & r = machine.payor;
+
+    payor = {{(int64_t)r.price(), (int64_t)r.numberOfPaymentsMade(), (int64_t)r.funds(), (int64_t)r.settlementFee(),
+              (int64_t)r.refundLockTime().counter(), (int64_t)r.anchor().index()}};
+    append(payorRaw, r.anchor().transactionId().toRPCByteOrderVector());
+    append(payorRaw, r.payeeContractPk().toCompressedRawVector());
+
+    const auto & e = machine.payee;
+
+    payee = {{(int64_t)e.price(), (int64_t)e.numberOfPaymentsMade(), (int64_t)e.funds(), (int64_t)e.settlementFee(),
+              (int64_t)e.lockTime().counter(), (int64_t)e.contractOutPoint().index()}};
+    append(payeeRaw, e.contractOutPoint().transactionId().toRPCByteOrderVector());
+    append(payeeRaw, e.lastValidPayorPaymentSignature().rawDER());
+    append(payeeRaw, e.payorContractPk().toCompressedRawVector());
+    append(payeeRaw, e.payorFinalPkHash().getRawVector());
+
+    const auto & a = machine.announcedModeAndTermsFromPeer;
+
+    modeAnnounced = static_cast<int>(a.modeAnnounced());
+
+    if(a.modeAnnounced() == protocol_statemachine::ModeAnnounced::sell) {
+
+      const auto & t = a.sellModeTerms();
+
+      announcedTerms = {{(int64_t)t.minPrice(), (int64_t)t.minLock(), (int64_t)t.maxSellers(), (int64_t)t.minContractFeePerKb(),
+                         (int64_t)t.settlementFee(), (int64_t)a.index()}};
+
+    } else if(a.modeAnnounced() == protocol_statemachine::ModeAnnounced::buy) {
+
+      const auto & t = a.buyModeTerms();
+
+      announcedTerms = {{(int64_t)t.maxPrice(), (int64_t)t.maxLock(), (int64_t)t.minNumberOfSellers(), (int64_t)t.maxContractFeePerKb(), 0, 0}};
+    }
+  }
+
+  uint32_t PeerFingerprint::changedFrom(const PeerFingerprint & o) const {
+
+    uint32_t changed = 0;
+
+    if(bep10 != o.bep10 || bitSwapr != o.bitSwapr)
+      changed |= BEPSupport;
+
+    if(hasConnection != o.hasConnection)
+      return changed | Connection;
+
+    if(innerState != o.innerState)
+      changed |= InnerState;
+
+    if(payor != o.payor || payorRaw != o.payorRaw)
+      changed |= Payor;
+
+    if(payee != o.payee || payeeRaw != o.payeeRaw)
+      changed |= Payee;
+
+    if(modeAnnounced != o.modeAnnounced || announcedTerms != o.announcedTerms)
+      changed |= AnnouncedModeAndTerms;
+
+    return changed;
+  }
+
+  TorrentFingerprint::TorrentFingerprint(const extension::status::TorrentPlugin & t)
+    : mode(static_cast<int>(t.session.mode))
+    , state(static_cast<int>(t.session.state))
+    , libtorrentInteraction(static_cast<int>(t.libtorrentInteraction))
+    , buyingState(-1)
+    , terms({{0, 0, 0, 0, 0}}) {
+
+    if(t.session.mode == protocol_session::SessionMode::selling) {
+
+      const auto & s = t.session.selling.terms;
+
+      terms = {{(int64_t)s.minPrice(), (int64_t)s.minLock(), (int64_t)s.maxSellers(), (int64_t)s.minContractFeePerKb(),
+                (int64_t)s.settlementFee()}};
+
+    } else if(t.session.mode == protocol_session::SessionMode::buying) {
+
+      const auto & b = t.session.buying.terms;
+
+      buyingState = static_cast<int>(t.session.buying.state);
+      terms = {{(int64_t)b.maxPrice(), (int64_t)b.maxLock(), (int64_t)b.minNumberOfSellers(), (int64_t)b.maxContractFeePerKb(), 0}};
+    }
+  }
+
+  bool TorrentFingerprint::operator!=(const TorrentFingerprint & o) const {
+    return mode != o.mode || state != o.state || libtorrentInteraction != o.libtorrentInteraction ||
+           buyingState != o.buyingState || terms != o.terms;
+  }
+
+  void Deltas::collect(const libtorrent::alert * a) {
+
+    if(auto p = libtorrent::alert_cast<extension::alert::TorrentPluginStatusUpdateAlert>(a))
+      collect(p);
+    else if(auto p = libtorrent::alert_cast<extension::alert::PeerPluginStatusUpdateAlert>(a))
+      collect(p);
+  }
+
+  void Deltas::collect(const extension::alert::TorrentPluginStatusUpdateAlert * p) {
+
+    std::set<libtorrent::sha1_hash> seen;
+
+    for(auto & m : p->statuses) {
+
+      const extension::status::TorrentPlugin & t = m.second;
+      TorrentFingerprint f(t);
+
+      seen.insert(t.infoHash);
+
+      auto last = _lastTorrents.find(t.infoHash);
+
+      if(last == _lastTorrents.end())
+        _lastTorrents.insert(std::make_pair(t.infoHash, f));
+      else if(last->second != f)
+        last->second = f;
+      else
+        continue;
+
+      _removedTorrents.erase(t.infoHash);
+      _pendingTorrents.erase(t.infoHash);
+      _pendingTorrents.insert(std::make_pair(t.infoHash, t));
+    }
+
+    for(auto it = _lastTorrents.begin();it != _lastTorrents.end();) {
+
+      if(seen.count(it->first) > 0) {
+        it++;
+        continue;
+      }
+
+      _pendingTorrents.erase(it->first);
+      _peers.erase(it->first);
+      _removedTorrents.insert(it->first);
+
+      it = _lastTorrents.erase(it);
+    }
+  }
+
+  void Deltas::collect(const extension::alert::PeerPluginStatusUpdateAlert * p) {
+
+    TorrentPeers & t = _peers[p->handle.info_hash()];
+
+    std::set<libtorrent::peer_id> seen;
+
+    for(auto & m : p->statuses) {
+
+      const extension::status::PeerPlugin & s = m.second;
+      PeerFingerprint f(s);
+
+      seen.insert(s.peerId);
+
+      auto last = t.last.find(s.peerId);
+
+      if(last == t.last.end()) {
+
+        t.last.insert(std::make_pair(s.peerId, f));
+        t.removed.erase(s.peerId);
+        setPending(t, s, 0, true);
+
+      } else {
+
+        uint32_t changed = f.changedFrom(last->second);
+
+        last->second = f;
+
+        if(changed != 0)
+          setPending(t, s, changed, false);
+      }
+    }
+
+    for(auto it = t.last.begin();it != t.last.end();) {
+
+      if(seen.count(it->first) > 0) {
+        it++;
+        continue;
+      }
+
+      auto pending = t.pending.find(it->first);
+      bool delivered = (pending == t.pending.end() || !pending->second.added);
+
+      if(pending != t.pending.end())
+        t.pending.erase(pending);
+
+      if(delivered)
+        t.removed.insert(it->first);
+
+      it = t.last.erase(it);
+    }
+  }
+
+  v8::Local<v8::Value> Deltas::take() {
+
+    v8::Local<v8::Array> peerChanges = Nan::New<v8::Array>();
+
+    for(auto & m : _peers) {
+
+      if(!m.second.hasChanges())
+        continue;
+
+      peerChanges->Set(peerChanges->Length(), encode(m.first, m.second));
+
+      m.second.pending.clear();
+      m.second.removed.clear();
+    }
+
+    if(_pendingTorrents.empty() && _removedTorrents.empty() && peerChanges->Length() == 0)
+      return Nan::Undefined();
+
+    v8::Local<v8::Array> torrents = Nan::New<v8::Array>();
+    for(auto & m : _pendingTorrents)
+      torrents->Set(torrents->Length(), torrent_plugin_status::encode(m.second));
+
+    v8::Local<v8::Array> removed = Nan::New<v8::Array>();
+    for(auto & infoHash : _removedTorrents)
+      removed->Set(removed->Length(), hashes::encodeInfoHash(infoHash));
+
+    _pendingTorrents.clear();
+    _removedTorrents.clear();
+
+    v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+    SET_VAL(o, "torrents", torrents);
+    SET_VAL(o, "removedTorrents", removed);
+    SET_VAL(o, "peers", peerChanges);
+
+    return o;
+  }
+
+  void Deltas::reset() {
+    _lastTorrents.clear();
+    _pendingTorrents.clear();
+    _removedTorrents.clear();
+    _peers.clear();
+  }
+
+}
+}
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_STATUS_DELTA_HPP
+#define JOYSTREAM_NODE_STATUS_DELTA_HPP
+
+#include <nan.h>
+
+#include <extension/extension.hpp>
+
+#include <array>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace joystream {
+namespace node {
+namespace status_delta {
+
+  /*
+   * Incremental delivery of TorrentPluginStatusUpdateAlert and PeerPluginStatusUpdateAlert.
+   *
+   * Status alerts are compared with the last status delivered, and only
+   * what changed is kept until taken, so any number of status updates
+   * in between two calls to `take` are coalesced into one delivery.
+   */
+
+  // Fields of peer status which are compared for changes
+  struct PeerFingerprint {
+
+    PeerFingerprint(const extension::status::PeerPlugin & s);
+
+    // PeerField values which differ from o
+    uint32_t changedFrom(const PeerFingerprint & o) const;
+
+    int bep10;
+    int bitSwapr;
+    bool hasConnection;
+    uint32_t innerState;
+
+    // Amounts, lock time and anchor index of payor and payee,
+    // followed by their anchor, keys and signature as raw bytes
+    std::array<int64_t, 6> payor;
+    std::vector<unsigned char> payorRaw;
+    std::array<int64_t, 6> payee;
+    std::vector<unsigned char> payeeRaw;
+
+    // Mode announced by peer, and fields of terms announced with it
+    int modeAnnounced;
+    std::array<int64_t, 6> announcedTerms;
+  };
+
+  struct PendingPeer {
+
+    PendingPeer(const extension::status::PeerPlugin & status, uint32_t changed, bool added)
+      : status(status)
+      , changed(changed)
+      , added(added) {
+    }
+
+    // Most recent status
+    extension::status::PeerPlugin status;
+
+    // PeerField values changed since last delivery
+    uint32_t changed;
+
+    // Whether peer was never delivered
+    bool added;
+  };
+
+  struct TorrentPeers {
+
+    bool hasChanges() const { return !pending.empty() || !removed.empty(); }
+
+    std::map<libtorrent::peer_id, PeerFingerprint> last;
+    std::map<libtorrent::peer_id, PendingPeer> pending;
+    std::set<libtorrent::peer_id> removed;
+  };
+
+  // Fields of torrent status which are compared for changes
+  struct TorrentFingerprint {
+
+    TorrentFingerprint(const extension::status::TorrentPlugin & t);
+
+    bool operator!=(const TorrentFingerprint & o) const;
+
+    int mode;
+    int state;
+    int libtorrentInteraction;
+
+    // Same fields as session::encode, which only delivers selling terms
+    // when selling, and buying state and terms when buying
+    int buyingState;
+    std::array<int64_t, 5> terms;
+  };
+
+  class Deltas {
+
+  public:
+
+    /* @brief Compares status alert with last delivered status, and records changes.
+     *
+     * @param a alert, TorrentPluginStatusUpdateAlert or PeerPluginStatusUpdateAlert
+     */
+    void collect(const libtorrent::alert * a);
+
+    /* @brief Creates javascript representation of changes since last call.
+     *
+     * @return v8::Local<v8::Value>, undefined if nothing changed, otherwise o where
+     *
+     * {Array} o.torrents - {see torrent_plugin_status::encode} for each torrent added or changed.
+     * {Array} o.removedTorrents - info hash of each torrent removed.
+     * {Array} o.peers - changes on peers of each torrent, d where
+     *   {String} d.infoHash - torrent
+     *   {Array} d.added - {see peer_plugin_status::encode} for each peer added.
+     *   {Array} d.changed - changed fields of each peer c, where c.pid is always set, and
+     *      innerState, peerBEP10SupportStatus, peerBitSwaprBEPSupportStatus, payor, payee,
+     *      announcedModeAndTermsFromPeer and connection are only set when changed,
+     *      see peer_plugin_status::encode and connection::encode.
+     *   {Array} d.removed - pid of each peer removed.
+     */
+    v8::Local<v8::Value> take();
+
+    /* @brief Forgets all statuses, so next update is delivered in full.
+     */
+    void reset();
+
+  private:
+
+    void collect(const extension::alert::TorrentPluginStatusUpdateAlert * p);
+
+    void collect(const extension::alert::PeerPluginStatusUpdateAlert * p);
+
+    std::map<libtorrent::sha1_hash, TorrentFingerprint> _lastTorrents;
+    std::map<libtorrent::sha1_hash, extension::status::TorrentPlugin> _pendingTorrents;
+    std::set<libtorrent::sha1_hash> _removedTorrents;
+
+    std::map<libtorrent::sha1_hash, TorrentPeers> _peers;
+  };
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_STATUS_DELTA_HPP
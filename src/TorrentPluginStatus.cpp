@@ -7,8 +7,10 @@
 
 #include "TorrentPluginStatus.hpp"
 #include "LibtorrentInteraction.hpp"
+#include "ObjectShape.hpp"
 #include "libtorrent-node/utils.hpp"
-#include "libtorrent-node/sha1_hash.hpp"
+#include "Hashes.hpp"
+#include "Tracing.hpp"
 #include "Session.hpp"
 #include <extension/extension.hpp>
 
@@ -20,12 +22,18 @@ namespace torrent_plugin_status {
     session::Init(target);
   }
 
+  enum Key { Session, InfoHash, LibtorrentInteraction };
+
   v8::Local<v8::Object> encode(const extension::status::TorrentPlugin & t) {
 
-    v8::Local<v8::Object> o = Nan::New<v8::Object>();
-    SET_VAL(o, "session", session::encode(t.session));
-    SET_VAL(o, "infoHash", libtorrent::node::sha1_hash::encode(t.infoHash));
-    SET_VAL(o, "libtorrentInteraction", joystream::node::libtorrent_interaction::encode(t.libtorrentInteraction));
+    tracing::Span span("torrent_plugin_status::encode", "status");
+
+    static const ObjectShape shape({"session", "infoHash", "libtorrentInteraction"});
+
+    v8::Local<v8::Object> o = shape.NewInstance();
+    shape.Set(o, Session, session::encode(t.session));
+    shape.Set(o, InfoHash, hashes::encodeInfoHash(t.infoHash));
+    shape.Set(o, LibtorrentInteraction, joystream::node::libtorrent_interaction::encode(t.libtorrentInteraction));
     return o;
   }
 
@@ -0,0 +1,84 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "TorrentSlots.hpp"
+
+#include <libtorrent/alert_types.hpp>
+
+namespace joystream {
+namespace node {
+namespace torrent_slots {
+
+  Slots::Slots()
+    : _nextSlot(0) {
+  }
+
+  void Slots::observe(const libtorrent::alert * a) {
+
+    switch(a->type()) {
+
+      case libtorrent::add_torrent_alert::alert_type:
+        {
+          auto p = static_cast<const libtorrent::add_torrent_alert *>(a);
+
+          if(!p->error && p->handle.is_valid())
+            assign(p->handle.info_hash());
+        }
+        break;
+
+      // Handle may no longer be valid, so info_hash is used
+      case libtorrent::torrent_removed_alert::alert_type:
+        retire(static_cast<const libtorrent::torrent_removed_alert *>(a)->info_hash);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  int32_t Slots::slot(const libtorrent::sha1_hash & infoHash) const {
+
+    auto it = _slots.find(infoHash);
+
+    return it == _slots.end() ? None : it->second;
+  }
+
+  void Slots::recycle() {
+    _freeSlots.insert(_freeSlots.end(), _retiredSlots.begin(), _retiredSlots.end());
+    _retiredSlots.clear();
+  }
+
+  void Slots::assign(const libtorrent::sha1_hash & infoHash) {
+
+    if(_slots.count(infoHash) > 0)
+      return;
+
+    int32_t s;
+
+    if(_freeSlots.empty())
+      s = _nextSlot++;
+    else {
+      s = _freeSlots.back();
+      _freeSlots.pop_back();
+    }
+
+    _slots.insert(std::make_pair(infoHash, s));
+  }
+
+  void Slots::retire(const libtorrent::sha1_hash & infoHash) {
+
+    auto it = _slots.find(infoHash);
+
+    if(it == _slots.end())
+      return;
+
+    _retiredSlots.push_back(it->second);
+    _slots.erase(it);
+  }
+
+}
+}
+}
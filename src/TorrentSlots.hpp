@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_TORRENT_SLOTS_HPP
+#define JOYSTREAM_NODE_TORRENT_SLOTS_HPP
+
+#include <libtorrent/sha1_hash.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace libtorrent {
+  class alert;
+}
+
+namespace joystream {
+namespace node {
+namespace torrent_slots {
+
+  /*
+   * Small integer id for each torrent in the session, so javascript can
+   * find the torrent of an alert by array index, rather than by reading
+   * and looking up its info hash.
+   *
+   * A slot is assigned when add_torrent_alert is encoded, and retired when
+   * torrent_removed_alert is encoded. Retired slots are only reused after
+   * `recycle`, which javascript calls once it has processed popped alerts, so
+   * a slot never refers to two torrents within one pop.
+   */
+
+  // No slot
+  const int32_t None = -1;
+
+  class Slots {
+
+  public:
+
+    Slots();
+
+    /* @brief Assigns or retires slot if alert is add_torrent_alert or torrent_removed_alert
+     *
+     * @param a alert
+     */
+    void observe(const libtorrent::alert * a);
+
+    /* @brief Slot of torrent
+     *
+     * @param infoHash torrent
+     * @return slot, or None if torrent has no slot
+     */
+    int32_t slot(const libtorrent::sha1_hash & infoHash) const;
+
+    /* @brief Makes retired slots available for new torrents
+     */
+    void recycle();
+
+  private:
+
+    // Info hashes are uniformly distributed, so a prefix is as good as any hash
+    struct InfoHashPrefix {
+      std::size_t operator()(const libtorrent::sha1_hash & h) const {
+        std::size_t prefix;
+        std::memcpy(&prefix, h.data(), sizeof(prefix));
+        return prefix;
+      }
+    };
+
+    void assign(const libtorrent::sha1_hash & infoHash);
+
+    void retire(const libtorrent::sha1_hash & infoHash);
+
+    std::unordered_map<libtorrent::sha1_hash, int32_t, InfoHashPrefix> _slots;
+    std::vector<int32_t> _freeSlots;
+    std::vector<int32_t> _retiredSlots;
+    int32_t _nextSlot;
+  };
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_TORRENT_SLOTS_HPP
@@ -0,0 +1,295 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#include "Tracing.hpp"
+#include "libtorrent-node/utils.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace joystream {
+namespace node {
+namespace tracing {
+
+  std::atomic<bool> active(false);
+
+  namespace {
+
+    // About 40MB per thread
+    const std::size_t MaxEventsPerThread = 1 << 20;
+
+    struct Event {
+
+      const char * name;
+      const char * category;
+
+      // Nanoseconds on steady clock
+      int64_t start;
+      int64_t duration;
+
+      // 'X' complete span, 'B' and 'E' begin and end of span from javascript
+      char phase;
+    };
+
+    struct ThreadBuffer {
+
+      ThreadBuffer(uint32_t tid)
+        : tid(tid)
+        , dropped(0) {
+      }
+
+      const uint32_t tid;
+
+      // Only contended while trace is started or stopped
+      std::mutex mutex;
+      std::vector<Event> events;
+      uint64_t dropped;
+    };
+
+    struct Registry {
+
+      std::mutex mutex;
+
+      // Kept after thread exits, so its events are still written
+      std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+      // Of trace being recorded, set on node thread
+      int64_t start = 0;
+      uint32_t nodeTid = 0;
+    };
+
+    Registry & registry() {
+      static Registry r;
+      return r;
+    }
+
+    ThreadBuffer & threadBuffer() {
+
+      thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+      if(!buffer) {
+
+        Registry & r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        buffer = std::make_shared<ThreadBuffer>((uint32_t)r.buffers.size() + 1);
+        r.buffers.push_back(buffer);
+      }
+
+      return *buffer;
+    }
+
+    int64_t nanoseconds(const std::chrono::steady_clock::time_point & t) {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    void push(const Event & e) {
+
+      ThreadBuffer & b = threadBuffer();
+      std::lock_guard<std::mutex> lock(b.mutex);
+
+      if(b.events.size() < MaxEventsPerThread)
+        b.events.push_back(e);
+      else
+        b.dropped++;
+    }
+
+    // Names of javascript spans, only ever touched on node thread
+    std::set<std::string> javascriptNames;
+
+    void appendEscaped(std::string & out, const char * s) {
+
+      for(;*s;s++) {
+
+        unsigned char c = (unsigned char)*s;
+
+        if(c == '"' || c == '\\') {
+          out.push_back('\\');
+          out.push_back((char)c);
+        } else if(c < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out.append(escaped);
+        } else
+          out.push_back((char)c);
+      }
+    }
+
+    void appendMicroseconds(std::string & out, int64_t nanoseconds) {
+      char value[32];
+      std::snprintf(value, sizeof(value), "%.3f", nanoseconds / 1000.0);
+      out.append(value);
+    }
+
+    void appendThreadName(std::string & out, uint32_t tid, const std::string & name) {
+      out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+      out.append(std::to_string(tid));
+      out.append(",\"args\":{\"name\":\"");
+      out.append(name);
+      out.append("\"}}");
+    }
+
+    // Chrome Trace Event JSON of events recorded since trace started, which are removed
+    std::string take() {
+
+      Registry & r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+
+      std::string out("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+      uint64_t dropped = 0;
+      bool first = true;
+
+      for(auto & buffer : r.buffers) {
+
+        std::vector<Event> events;
+
+        {
+          std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+          events.swap(buffer->events);
+          dropped += buffer->dropped;
+          buffer->dropped = 0;
+        }
+
+        if(!first)
+          out.push_back(',');
+
+        first = false;
+
+        appendThreadName(out, buffer->tid, buffer->tid == r.nodeTid ? "node" : "thread " + std::to_string(buffer->tid));
+
+        for(auto & e : events) {
+
+          out.append(",{\"name\":\"");
+          appendEscaped(out, e.name);
+          out.append("\",\"cat\":\"");
+          appendEscaped(out, e.category);
+          out.append("\",\"ph\":\"");
+          out.push_back(e.phase);
+          out.append("\",\"ts\":");
+          appendMicroseconds(out, e.start - r.start);
+
+          if(e.phase == 'X') {
+            out.append(",\"dur\":");
+            appendMicroseconds(out, e.duration);
+          }
+
+          out.append(",\"pid\":1,\"tid\":");
+          out.append(std::to_string(buffer->tid));
+          out.push_back('}');
+        }
+      }
+
+      out.append("],\"otherData\":{\"droppedEvents\":");
+      out.append(std::to_string(dropped));
+      out.append("}}");
+
+      return out;
+    }
+
+    NAN_METHOD(StartTrace) {
+
+      active.store(false, std::memory_order_relaxed);
+
+      // Discard earlier recording
+      take();
+
+      Registry & r = registry();
+      uint32_t tid = threadBuffer().tid;
+
+      {
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        r.start = nanoseconds(std::chrono::steady_clock::now());
+        r.nodeTid = tid;
+      }
+
+      active.store(true, std::memory_order_relaxed);
+
+      RETURN_VOID
+    }
+
+    NAN_METHOD(StopTrace) {
+
+      active.store(false, std::memory_order_relaxed);
+
+      std::string trace = take();
+
+      if(info.Length() < 1 || info[0]->IsUndefined()) {
+        RETURN(Nan::New(trace).ToLocalChecked())
+      }
+
+      if(!info[0]->IsString())
+        return Nan::ThrowTypeError("Argument 0 must be a path");
+
+      std::ofstream file(*Nan::Utf8String(info[0]), std::ios::out | std::ios::trunc);
+
+      file.write(trace.data(), trace.size());
+      file.close();
+
+      if(!file)
+        return Nan::ThrowError("Could not write trace");
+
+      RETURN_VOID
+    }
+
+    NAN_METHOD(TraceBegin) {
+
+      if(!active.load(std::memory_order_relaxed)) {
+        RETURN_VOID
+      }
+
+      if(info.Length() < 1 || !info[0]->IsString())
+        return Nan::ThrowTypeError("Argument 0 must be a name");
+
+      const char * name = javascriptNames.insert(*Nan::Utf8String(info[0])).first->c_str();
+
+      push(Event{name, "javascript", nanoseconds(std::chrono::steady_clock::now()), 0, 'B'});
+
+      RETURN_VOID
+    }
+
+    NAN_METHOD(TraceEnd) {
+
+      if(!active.load(std::memory_order_relaxed)) {
+        RETURN_VOID
+      }
+
+      push(Event{"", "javascript", nanoseconds(std::chrono::steady_clock::now()), 0, 'E'});
+
+      RETURN_VOID
+    }
+
+  }
+
+  NAN_MODULE_INIT(Init) {
+
+    Nan::Set(target, Nan::New("startTrace").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(StartTrace)->GetFunction());
+    Nan::Set(target, Nan::New("stopTrace").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(StopTrace)->GetFunction());
+    Nan::Set(target, Nan::New("traceBegin").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(TraceBegin)->GetFunction());
+    Nan::Set(target, Nan::New("traceEnd").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(TraceEnd)->GetFunction());
+  }
+
+  void record(const char * name, const char * category,
+              const std::chrono::steady_clock::time_point & start,
+              const std::chrono::steady_clock::time_point & end) {
+
+    int64_t s = nanoseconds(start);
+
+    push(Event{name, category, s, nanoseconds(end) - s, 'X'});
+  }
+
+}
+}
+}
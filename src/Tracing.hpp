@@ -0,0 +1,83 @@
+/**
+ * Copyright (C) JoyStream - All Rights Reserved
+ * Unauthorized copying of this file, via any medium is strictly prohibited
+ * Proprietary and confidential
+ */
+
+#ifndef JOYSTREAM_NODE_TRACING_HPP
+#define JOYSTREAM_NODE_TRACING_HPP
+
+#include <nan.h>
+
+#include <atomic>
+#include <chrono>
+
+namespace joystream {
+namespace node {
+namespace tracing {
+
+  /*
+   * Opt in recording of spans, written as Chrome Trace Event JSON, which
+   * chrome://tracing and Perfetto open.
+   *
+   * Each thread records into its own buffer, so recording takes no lock
+   * shared with other threads, and while not tracing a span costs one
+   * relaxed atomic load.
+   */
+
+  // Exports
+  // - "startTrace" () discards any earlier recording and starts recording
+  // - "stopTrace" ([path]) stops recording, and writes trace to path, or returns it as a string
+  // - "traceBegin" (name) and "traceEnd" () delimit a span on node thread,
+  //   for marking javascript work in the same timeline
+  NAN_MODULE_INIT(Init);
+
+  // Whether spans are recorded
+  extern std::atomic<bool> active;
+
+  /* @brief Records span in buffer of calling thread.
+   *
+   * @param name of span, must outlive trace, such as a string literal
+   * @param category of span
+   * @param start of span
+   * @param end of span
+   */
+  void record(const char * name, const char * category,
+              const std::chrono::steady_clock::time_point & start,
+              const std::chrono::steady_clock::time_point & end);
+
+  /**
+   * @brief Records a span from construction to destruction, if tracing
+   * when constructed.
+   */
+  class Span {
+
+  public:
+
+    Span(const char * name, const char * category)
+      : _name(name)
+      , _category(category)
+      , _active(active.load(std::memory_order_relaxed)) {
+
+      if(_active)
+        _start = std::chrono::steady_clock::now();
+    }
+
+    ~Span() {
+      if(_active)
+        record(_name, _category, _start, std::chrono::steady_clock::now());
+    }
+
+  private:
+
+    const char * _name;
+    const char * _category;
+    bool _active;
+    std::chrono::steady_clock::time_point _start;
+  };
+
+}
+}
+}
+
+#endif // JOYSTREAM_NODE_TRACING_HPP
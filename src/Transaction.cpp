@@ -8,11 +8,13 @@ namespace transaction {
 
 v8::Local<v8::Object> encode(const Coin::Transaction &tx) {
     auto data = tx.getSerialized();
-    return UCharVectorToNodeBuffer(data);
+    return UCharVectorToNodeBuffer(std::move(data));
 }
 
 Coin::Transaction decode(const v8::Local<v8::Value>& value) {
-    return Coin::Transaction(NodeBufferToUCharVector(value));
+    // Parsed from buffer memory directly, rather than through an intermediate std::vector
+    auto view = NodeBufferToView(value);
+    return Coin::Transaction(uchar_vector(view.data, (unsigned int)view.size));
 }
 
 }
@@ -5,20 +5,35 @@
 namespace joystream {
 namespace node {
 
-std::vector<unsigned char> NodeBufferToUCharVector(v8::Local<v8::Value> buffer) {
+namespace {
+
+// Below this size a copy is cheaper than tracking an external backing store,
+// which covers keys, hashes and signatures
+const std::size_t ExternalBufferMinimumSize = 256;
+
+void FreeVector(char *, void * hint) {
+    delete static_cast<std::vector<unsigned char> *>(hint);
+}
+
+}
+
+NodeBufferView NodeBufferToView(v8::Local<v8::Value> buffer) {
     if(!buffer->IsUint8Array()){
         throw std::runtime_error("argument is not a node buffer");
     }
 
-    auto length = ::node::Buffer::Length(buffer);
+    NodeBufferView view;
 
-    std::vector<unsigned char> vector(length);
+    view.data = reinterpret_cast<const unsigned char *>(::node::Buffer::Data(buffer));
+    view.size = ::node::Buffer::Length(buffer);
 
-    auto begin = ::node::Buffer::Data(buffer);
+    return view;
+}
 
-    std::copy(begin, begin + length, vector.data());
+std::vector<unsigned char> NodeBufferToUCharVector(v8::Local<v8::Value> buffer) {
+    auto view = NodeBufferToView(buffer);
 
-    return vector;
+    return std::vector<unsigned char>(view.begin(), view.end());
 }
 
 std::vector<unsigned char> StringToUCharVector(v8::Local<v8::Value> value) {
@@ -26,11 +41,20 @@ std::vector<unsigned char> StringToUCharVector(v8::Local<v8::Value> value) {
     return Coin::fromHex(hex);
 }
 
-v8::Local<v8::Object> UCharVectorToNodeBuffer(std::vector<unsigned char> &data) {
+v8::Local<v8::Object> UCharVectorToNodeBuffer(const std::vector<unsigned char> &data) {
     auto buffer = Nan::NewBuffer(data.size()).ToLocalChecked();
     auto pbuf = ::node::Buffer::Data(buffer);
     std::copy(data.begin(), data.end(), pbuf);
     return buffer;
 }
 
+v8::Local<v8::Object> UCharVectorToNodeBuffer(std::vector<unsigned char> &&data) {
+    if(data.size() < ExternalBufferMinimumSize)
+        return UCharVectorToNodeBuffer(static_cast<const std::vector<unsigned char> &>(data));
+
+    auto owner = new std::vector<unsigned char>(std::move(data));
+
+    return Nan::NewBuffer(reinterpret_cast<char *>(owner->data()), owner->size(), FreeVector, owner).ToLocalChecked();
+}
+
 }}
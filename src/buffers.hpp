@@ -8,6 +8,27 @@ namespace node {
 
 // Utility Methods to convert between node Buffer and std::vector<unsigned char>
 
+/**
+ * @brief Read only view of the memory of a node Buffer, only valid
+ * as long as the buffer is, so it must not outlive the call it was made in.
+ */
+struct NodeBufferView {
+
+  const unsigned char * begin() const { return data; }
+  const unsigned char * end() const { return data + size; }
+
+  const unsigned char * data;
+  std::size_t size;
+};
+
+/**
+ * @brief Views data of a node Buffer without copying
+ * @param {v8::Local<v8::Value>} value
+ * @throws std::runtime_error if value not a node buffer
+ * @return NodeBufferView
+ */
+NodeBufferView NodeBufferToView(v8::Local<v8::Value>);
+
 /**
  * @brief Copies data from a node Buffer into a new std::vector<unsigned char>
  * @param {v8::Local<v8::Value>} value
@@ -29,7 +50,16 @@ std::vector<unsigned char> NodeBufferToUCharVector(v8::Local<v8::Value>);
  * @param std::vector<unsigned char> data
  * @return {v8::Local<v8::Value>} node Buffer
  */
-v8::Local<v8::Object> UCharVectorToNodeBuffer(std::vector<unsigned char>&);
+v8::Local<v8::Object> UCharVectorToNodeBuffer(const std::vector<unsigned char>&);
+
+/**
+ * @brief Moves data into a new node Buffer backed by the vector storage,
+ * which is freed when the buffer is garbage collected. Small data is copied,
+ * as that is cheaper than an externally backed buffer.
+ * @param std::vector<unsigned char> data, left in a valid but unspecified state
+ * @return {v8::Local<v8::Value>} node Buffer
+ */
+v8::Local<v8::Object> UCharVectorToNodeBuffer(std::vector<unsigned char>&&);
 
 }
 }
@@ -5,9 +5,14 @@
 #include "Signature.hpp"
 #include "OutPoint.hpp"
 #include "Transaction.hpp"
+#include "PublicKeyCache.hpp"
 
 #include <common/PrivateKey.hpp>
 #include <common/KeyPair.hpp>
+#include <common/PublicKey.hpp>
+#include <common/PubKeyHash.hpp>
+#include <common/Signature.hpp>
+#include <common/typesafeOutPoint.hpp>
 
 #include "libtorrent-node/utils.hpp"
 #include "buffers.hpp"
@@ -17,6 +22,19 @@
 
 #include <CoinCore/CoinNodeData.h>
 
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 namespace joystream {
 namespace node {
 namespace payment_channel {
@@ -31,12 +49,285 @@ namespace payment_channel {
     Nan::Set(target, Nan::New("commitmentToOutput").ToLocalChecked(),
       Nan::New<v8::FunctionTemplate>(commitment::CommitmentToOutput)->GetFunction());
 
+    Nan::Set(target, Nan::New("commitmentToOutputAsync").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(commitment::CommitmentToOutputAsync)->GetFunction());
+
+    Nan::Set(target, Nan::New("commitmentsToOutputs").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(commitment::CommitmentsToOutputs)->GetFunction());
+
+    Nan::Set(target, Nan::New("publicKeyCacheStats").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(public_key_cache::Stats)->GetFunction());
+
     Nan::Set(target, Nan::New("createSettlementTransaction").ToLocalChecked(),
       Nan::New<v8::FunctionTemplate>(settlement::CreateSettlementTransaction)->GetFunction());
+
+    Nan::Set(target, Nan::New("createSettlementTransactionAsync").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(settlement::CreateSettlementTransactionAsync)->GetFunction());
+
+    Nan::Set(target, Nan::New("createSettlementTransactions").ToLocalChecked(),
+      Nan::New<v8::FunctionTemplate>(settlement::CreateSettlementTransactions)->GetFunction());
+  }
+
+  /*
+   * Worker making a raw transaction or output off the node thread. All arguments
+   * are decoded up front on the node thread, so Execute only does the crypto.
+   */
+  class RawWorker : public Nan::AsyncWorker {
+
+  public:
+
+    RawWorker(Nan::Callback * callback, const std::function<std::vector<unsigned char>()> & make)
+      : Nan::AsyncWorker(callback)
+      , _make(make) {
+    }
+
+    void Execute() {
+
+      try {
+        _raw = _make();
+      } catch(std::exception &e) {
+        SetErrorMessage(e.what());
+      }
+    }
+
+    void HandleOKCallback() {
+
+      Nan::HandleScope scope;
+
+      v8::Local<v8::Value> argv[] = { Nan::Null(), UCharVectorToNodeBuffer(std::move(_raw)) };
+
+      callback->Call(2, argv);
+    }
+
+  private:
+
+    std::function<std::vector<unsigned char>()> _make;
+
+    std::vector<unsigned char> _raw;
+  };
+
+  /*
+   * Items of a batch made in parallel on the libuv thread pool, where each
+   * item either produces raw bytes or fails on its own, without failing the batch.
+   */
+  class Batch {
+
+  public:
+
+    // Makes raw bytes of item with given index, may throw
+    typedef std::function<std::vector<unsigned char>(std::size_t)> ItemMaker;
+
+    Batch(std::size_t size, Nan::Callback * callback)
+      : _raw(size)
+      , _errors(size)
+      , _remainingWorkers(0)
+      , _callback(callback) {
+    }
+
+    std::size_t size() const { return _raw.size(); }
+
+    // Marks item as failed, it will not be made
+    void fail(std::size_t i, const std::string & error) {
+      _errors[i] = error;
+    }
+
+    /* @brief Splits items across as many workers as there are pool threads,
+     * and calls callback with (null, {results, errors}) when all are done, where
+     * results[i] is a node Buffer and errors[i] is null, or results[i] is null
+     * and errors[i] is an Error.
+     */
+    static void Queue(const std::shared_ptr<Batch> & batch, const ItemMaker & make);
+
+  private:
+
+    class Worker;
+
+    void make(const ItemMaker & make, std::size_t begin, std::size_t end) {
+
+      for(std::size_t i = begin;i < end;i++) {
+
+        if(!_errors[i].empty())
+          continue;
+
+        try {
+          _raw[i] = make(i);
+        } catch(std::exception &e) {
+          _errors[i] = e.what();
+        }
+      }
+    }
+
+    void workerDone() {
+
+      if(--_remainingWorkers > 0)
+        return;
+
+      v8::Local<v8::Array> results = Nan::New<v8::Array>((int)size());
+      v8::Local<v8::Array> errors = Nan::New<v8::Array>((int)size());
+
+      for(std::size_t i = 0;i < size();i++) {
+
+        if(_errors[i].empty()) {
+          Nan::Set(results, (uint32_t)i, UCharVectorToNodeBuffer(std::move(_raw[i])));
+          Nan::Set(errors, (uint32_t)i, Nan::Null());
+        } else {
+          Nan::Set(results, (uint32_t)i, Nan::Null());
+          Nan::Set(errors, (uint32_t)i, Nan::Error(_errors[i].c_str()));
+        }
+      }
+
+      v8::Local<v8::Object> o = Nan::New<v8::Object>();
+
+      SET_VAL(o, "results", results);
+      SET_VAL(o, "errors", errors);
+
+      v8::Local<v8::Value> argv[] = { Nan::Null(), o };
+
+      _callback->Call(2, argv);
+    }
+
+    // Distinct items are only ever written by one worker
+    std::vector<std::vector<unsigned char>> _raw;
+    std::vector<std::string> _errors;
+
+    // Only touched on node thread
+    std::size_t _remainingWorkers;
+
+    std::unique_ptr<Nan::Callback> _callback;
+  };
+
+  class Batch::Worker : public Nan::AsyncWorker {
+
+  public:
+
+    Worker(const std::shared_ptr<Batch> & batch, const ItemMaker & make, std::size_t begin, std::size_t end)
+      : Nan::AsyncWorker(nullptr)
+      , _batch(batch)
+      , _make(make)
+      , _begin(begin)
+      , _end(end) {
+    }
+
+    void Execute() {
+      _batch->make(_make, _begin, _end);
+    }
+
+    void HandleOKCallback() {
+
+      Nan::HandleScope scope;
+
+      _batch->workerDone();
+    }
+
+  private:
+
+    std::shared_ptr<Batch> _batch;
+    ItemMaker _make;
+    std::size_t _begin, _end;
+  };
+
+  void Batch::Queue(const std::shared_ptr<Batch> & batch, const ItemMaker & make) {
+
+    // Same default as libuv
+    std::size_t threads = 4;
+
+    if(const char * s = std::getenv("UV_THREADPOOL_SIZE"))
+      threads = std::max(1, std::atoi(s));
+
+    std::size_t workers = std::max<std::size_t>(1, std::min(batch->size(), threads));
+    std::size_t itemsPerWorker = (batch->size() + workers - 1) / workers;
+
+    batch->_remainingWorkers = workers;
+
+    for(std::size_t w = 0;w < workers;w++) {
+
+      std::size_t begin = std::min(batch->size(), w * itemsPerWorker);
+      std::size_t end = std::min(batch->size(), begin + itemsPerWorker);
+
+      Nan::AsyncQueueWorker(new Worker(batch, make, begin, end));
+    }
   }
 
 namespace commitment {
 
+  // Commitment as decoded, before any key derivation
+  struct Parameters {
+    int64_t value;
+    int32_t relativeLocktime;
+    Coin::PrivateKey payorSk;
+    Coin::PublicKey payeePk;
+  };
+
+  Parameters decodeParameters(const v8::Local<v8::Value> &commitment);
+
+  paymentchannel::Commitment toCommitment(const Parameters & parameters);
+
+  paymentchannel::Commitment toCommitment(const Parameters & parameters, const Coin::PublicKey & payorPk);
+
+  // Payor key shared by commitments of a batch, whose public key
+  // is derived by whichever worker needs it first
+  struct PayorKey {
+
+    explicit PayorKey(const Coin::PrivateKey & sk)
+      : sk(sk) {
+    }
+
+    const Coin::PublicKey & pk() {
+      std::call_once(_derived, [this]() { _pk = public_key_cache::derive(sk); });
+      return _pk;
+    }
+
+    const Coin::PrivateKey sk;
+
+  private:
+
+    std::once_flag _derived;
+    Coin::PublicKey _pk;
+  };
+
+  /*
+   * Distinct payor keys of a batch, told apart by SHA-256 digest
+   * like public_key_cache, and only used on the node thread.
+   */
+  class PayorKeys {
+
+  public:
+
+    ~PayorKeys() {
+      for(auto & d : _digests)
+        OPENSSL_cleanse(d.data(), d.size());
+    }
+
+    std::shared_ptr<PayorKey> of(const Coin::PrivateKey & sk) {
+
+      std::array<unsigned char, SHA256_DIGEST_LENGTH> digest;
+
+      {
+        std::vector<unsigned char> raw = sk.toRawVector();
+        SHA256(raw.data(), raw.size(), digest.data());
+        OPENSSL_cleanse(raw.data(), raw.size());
+      }
+
+      for(std::size_t i = 0;i < _digests.size();i++)
+        if(std::memcmp(_digests[i].data(), digest.data(), digest.size()) == 0) {
+          OPENSSL_cleanse(digest.data(), digest.size());
+          return _keys[i];
+        }
+
+      _digests.push_back(digest);
+      _keys.push_back(std::make_shared<PayorKey>(sk));
+
+      OPENSSL_cleanse(digest.data(), digest.size());
+
+      return _keys.back();
+    }
+
+  private:
+
+    std::vector<std::array<unsigned char, SHA256_DIGEST_LENGTH>> _digests;
+    std::vector<std::shared_ptr<PayorKey>> _keys;
+  };
+
   NAN_METHOD(CommitmentToOutput) {
     ARGUMENTS_REQUIRE_DECODED(0, commitment, paymentchannel::Commitment, decode)
 
@@ -50,10 +341,55 @@ namespace commitment {
 
     auto rawoutput = txout.getSerialized();
 
-    info.GetReturnValue().Set(UCharVectorToNodeBuffer(rawoutput));
+    info.GetReturnValue().Set(UCharVectorToNodeBuffer(std::move(rawoutput)));
   }
 
-  paymentchannel::Commitment decode(const v8::Local<v8::Value> &commitment) {
+  NAN_METHOD(CommitmentToOutputAsync) {
+    ARGUMENTS_REQUIRE_DECODED(0, parameters, Parameters, decodeParameters)
+    ARGUMENTS_REQUIRE_FUNCTION(1, callback)
+
+    Nan::AsyncQueueWorker(new RawWorker(new Nan::Callback(callback), [parameters]() -> std::vector<unsigned char> {
+      return toCommitment(parameters).contractOutput().getSerialized();
+    }));
+
+    RETURN_VOID
+  }
+
+  NAN_METHOD(CommitmentsToOutputs) {
+    ARGUMENTS_REQUIRE_FUNCTION(1, callback)
+
+    if(!info[0]->IsArray())
+      return Nan::ThrowTypeError("Argument 0 must be an array of commitments");
+
+    v8::Local<v8::Array> commitments = v8::Local<v8::Array>::Cast(info[0]);
+
+    auto batch = std::make_shared<Batch>(commitments->Length(), new Nan::Callback(callback));
+    auto parameters = std::make_shared<std::vector<Parameters>>(commitments->Length());
+    auto payorKeys = std::make_shared<std::vector<std::shared_ptr<PayorKey>>>(commitments->Length());
+
+    // The same payorSk is used for every commitment of a contract, so commitments
+    // sharing it share one PayorKey, and its public key is only derived once
+    PayorKeys distinctPayorKeys;
+
+    // Decode everything up front, a bad commitment only fails its own output
+    for(uint32_t i = 0;i < commitments->Length();i++) {
+
+      try {
+        (*parameters)[i] = decodeParameters(Nan::Get(commitments, i).ToLocalChecked());
+        (*payorKeys)[i] = distinctPayorKeys.of((*parameters)[i].payorSk);
+      } catch(std::exception &e) {
+        batch->fail(i, e.what());
+      }
+    }
+
+    Batch::Queue(batch, [parameters, payorKeys](std::size_t i) -> std::vector<unsigned char> {
+      return toCommitment((*parameters)[i], (*payorKeys)[i]->pk()).contractOutput().getSerialized();
+    });
+
+    RETURN_VOID
+  }
+
+  Parameters decodeParameters(const v8::Local<v8::Value> &commitment) {
     if(!commitment->IsObject()){
         throw std::runtime_error("argument not an Object");
     }
@@ -66,9 +402,11 @@ namespace commitment {
       throw std::runtime_error("value is not a Number");
     }
 
-    int64_t outputValue = ToNative<int64_t>(value); // Number satoshi
+    Parameters parameters;
 
-    if(outputValue < 0) {
+    parameters.value = ToNative<int64_t>(value); // Number satoshi
+
+    if(parameters.value < 0) {
       throw std::runtime_error("value is negative");
     }
 
@@ -78,62 +416,203 @@ namespace commitment {
       throw std::runtime_error("locktime is not a Number");
     }
 
-    int32_t relativeLocktime = ToNative<int32_t>(locktime); // Number locktime counter;
-    if(relativeLocktime < 0) {
+    parameters.relativeLocktime = ToNative<int32_t>(locktime); // Number locktime counter;
+    if(parameters.relativeLocktime < 0) {
       throw std::runtime_error("locktime value is negative");
     }
 
-    auto payorSk = GET_VAL(obj, PAYOR_KEY); // private_key
+    parameters.payorSk = private_key::decode(GET_VAL(obj, PAYOR_KEY));
+
+    parameters.payeePk = public_key::decode(GET_VAL(obj, PAYEE_KEY));
 
-    auto payeePk = GET_VAL(obj, PAYEE_KEY); // public_key
+    return parameters;
+  }
+
+  paymentchannel::Commitment toCommitment(const Parameters & parameters) {
+    return toCommitment(parameters, public_key_cache::derive(parameters.payorSk));
+  }
 
-    return paymentchannel::Commitment(outputValue,
-                                      private_key::decode(payorSk).toPublicKey(),
-                                      public_key::decode(payeePk),
+  paymentchannel::Commitment toCommitment(const Parameters & parameters, const Coin::PublicKey & payorPk) {
+    return paymentchannel::Commitment(parameters.value,
+                                      payorPk,
+                                      parameters.payeePk,
                                       //relative_locktime::decode(locktime)); //todo
-                                      Coin::RelativeLockTime::fromTimeUnits(relativeLocktime));
+                                      Coin::RelativeLockTime::fromTimeUnits(parameters.relativeLocktime));
+  }
+
+  paymentchannel::Commitment decode(const v8::Local<v8::Value> &commitment) {
+    return toCommitment(decodeParameters(commitment));
   }
 
 } // commitment namespace
 
 namespace settlement {
 
+  // Arguments of CreateSettlementTransaction, before any key derivation
+  struct Parameters {
+    uint64_t numberOfPaymentsMade;
+    uint32_t refundLockTime;
+    int64_t price;
+    int64_t funds;
+    int64_t settlementFee;
+    Coin::typesafeOutPoint contractOutPoint;
+    Coin::PrivateKey payeeContractPrivKey;
+    Coin::PubKeyHash payeeFinalPkHash;
+    Coin::PublicKey payorContractPk;
+    Coin::PubKeyHash payorFinalPkHash;
+    Coin::Signature lastValidPayorPaymentSignature;
+  };
+
+  Coin::Transaction settlementTransaction(const Parameters & p);
+
+  Parameters decodeParameters(const v8::Local<v8::Value> & descriptor);
+
+  // TODO: implement decode method? ARGUMENTS_REQUIRE_DECODED(0, payee, paymentchannel::Payee, decode)
+  #define ARGUMENTS_REQUIRE_SETTLEMENT_PARAMETERS(var) \
+    ARGUMENTS_REQUIRE_NUMBER(0, numberOfPaymentsMade) \
+    ARGUMENTS_REQUIRE_NUMBER(1, refundLockTime) \
+    ARGUMENTS_REQUIRE_NUMBER(2, price) \
+    ARGUMENTS_REQUIRE_NUMBER(3, funds) \
+    ARGUMENTS_REQUIRE_NUMBER(4, settlementFee) \
+    ARGUMENTS_REQUIRE_DECODED(5, contractOutPoint, Coin::typesafeOutPoint, outpoint::decode) \
+    ARGUMENTS_REQUIRE_DECODED(6, payeeContractPrivKey, Coin::PrivateKey, private_key::decode) \
+    ARGUMENTS_REQUIRE_DECODED(7, payeeFinalPkHash, Coin::PubKeyHash, pubkey_hash::decode) \
+    ARGUMENTS_REQUIRE_DECODED(8, payorContractPk, Coin::PublicKey, public_key::decode) \
+    ARGUMENTS_REQUIRE_DECODED(9, payorFinalPkHash, Coin::PubKeyHash, pubkey_hash::decode) \
+    ARGUMENTS_REQUIRE_DECODED(10, lastValidPayorPaymentSignature, Coin::Signature, signature::decode) \
+    Parameters var; \
+    var.numberOfPaymentsMade = numberOfPaymentsMade; \
+    var.refundLockTime = refundLockTime; \
+    var.price = price; \
+    var.funds = funds; \
+    var.settlementFee = settlementFee; \
+    var.contractOutPoint = contractOutPoint; \
+    var.payeeContractPrivKey = payeeContractPrivKey; \
+    var.payeeFinalPkHash = payeeFinalPkHash; \
+    var.payorContractPk = payorContractPk; \
+    var.payorFinalPkHash = payorFinalPkHash; \
+    var.lastValidPayorPaymentSignature = lastValidPayorPaymentSignature;
+
   NAN_METHOD(CreateSettlementTransaction) {
-    // TODO: implement decode method? ARGUMENTS_REQUIRE_DECODED(0, payee, paymentchannel::Payee, decode)
-
-    ARGUMENTS_REQUIRE_NUMBER(0, numberOfPaymentsMade)
-    ARGUMENTS_REQUIRE_NUMBER(1, refundLockTime)
-    ARGUMENTS_REQUIRE_NUMBER(2, price)
-    ARGUMENTS_REQUIRE_NUMBER(3, funds)
-    ARGUMENTS_REQUIRE_NUMBER(4, settlementFee)
-    ARGUMENTS_REQUIRE_DECODED(5, contractOutPoint, Coin::typesafeOutPoint, outpoint::decode)
-    ARGUMENTS_REQUIRE_DECODED(6, payeeContractPrivKey, Coin::PrivateKey, private_key::decode)
-    ARGUMENTS_REQUIRE_DECODED(7, payeeFinalPkHash, Coin::PubKeyHash, pubkey_hash::decode)
-    ARGUMENTS_REQUIRE_DECODED(8, payorContractPk, Coin::PublicKey, public_key::decode)
-    ARGUMENTS_REQUIRE_DECODED(9, payorFinalPkHash, Coin::PubKeyHash, pubkey_hash::decode)
-    ARGUMENTS_REQUIRE_DECODED(10, lastValidPayorPaymentSignature, Coin::Signature, signature::decode)
-
-    paymentchannel::Payee payee(numberOfPaymentsMade,
-                                Coin::RelativeLockTime::fromTimeUnits(refundLockTime),
-                                price,
-                                funds,
-                                settlementFee,
-                                contractOutPoint,
-                                Coin::KeyPair(payeeContractPrivKey),
-                                payeeFinalPkHash,
-                                payorContractPk,
-                                payorFinalPkHash,
-                                lastValidPayorPaymentSignature);
+    ARGUMENTS_REQUIRE_SETTLEMENT_PARAMETERS(parameters)
 
     try {
 
-      info.GetReturnValue().Set(transaction::encode(payee.lastPaymentTransaction()));
+      info.GetReturnValue().Set(transaction::encode(settlementTransaction(parameters)));
 
     } catch(std::exception &e) {
       return Nan::ThrowError(e.what());
     }
 
   }
+
+  NAN_METHOD(CreateSettlementTransactionAsync) {
+    ARGUMENTS_REQUIRE_SETTLEMENT_PARAMETERS(parameters)
+    ARGUMENTS_REQUIRE_FUNCTION(11, callback)
+
+    Nan::AsyncQueueWorker(new RawWorker(new Nan::Callback(callback), [parameters]() -> std::vector<unsigned char> {
+      return settlementTransaction(parameters).getSerialized();
+    }));
+
+    RETURN_VOID
+  }
+
+  NAN_METHOD(CreateSettlementTransactions) {
+    ARGUMENTS_REQUIRE_FUNCTION(1, callback)
+
+    if(!info[0]->IsArray())
+      return Nan::ThrowTypeError("Argument 0 must be an array of descriptors");
+
+    v8::Local<v8::Array> descriptors = v8::Local<v8::Array>::Cast(info[0]);
+
+    auto batch = std::make_shared<Batch>(descriptors->Length(), new Nan::Callback(callback));
+    auto parameters = std::make_shared<std::vector<Parameters>>(descriptors->Length());
+
+    // Decode everything up front, a bad descriptor only fails its own transaction
+    for(uint32_t i = 0;i < descriptors->Length();i++) {
+
+      try {
+        (*parameters)[i] = decodeParameters(Nan::Get(descriptors, i).ToLocalChecked());
+      } catch(std::exception &e) {
+        batch->fail(i, e.what());
+      }
+    }
+
+    Batch::Queue(batch, [parameters](std::size_t i) -> std::vector<unsigned char> {
+      return settlementTransaction((*parameters)[i]).getSerialized();
+    });
+
+    RETURN_VOID
+  }
+
+  #define NUMBER_OF_PAYMENTS_MADE_KEY "numberOfPaymentsMade"
+  #define REFUND_LOCK_TIME_KEY "refundLockTime"
+  #define PRICE_KEY "price"
+  #define FUNDS_KEY "funds"
+  #define SETTLEMENT_FEE_KEY "settlementFee"
+  #define CONTRACT_OUTPOINT_KEY "contractOutPoint"
+  #define PAYEE_CONTRACT_SK_KEY "payeeContractPrivKey"
+  #define PAYEE_FINAL_PK_HASH_KEY "payeeFinalPkHash"
+  #define PAYOR_CONTRACT_PK_KEY "payorContractPk"
+  #define PAYOR_FINAL_PK_HASH_KEY "payorFinalPkHash"
+  #define LAST_VALID_PAYOR_PAYMENT_SIGNATURE_KEY "lastValidPayorPaymentSignature"
+
+  static int64_t decodeNumber(const v8::Local<v8::Object> & o, const char * key) {
+
+    auto value = GET_VAL(o, key);
+
+    if(!value->IsNumber())
+      throw std::runtime_error(std::string(key) + " is not a Number");
+
+    int64_t n = ToNative<int64_t>(value);
+
+    if(n < 0)
+      throw std::runtime_error(std::string(key) + " is negative");
+
+    return n;
+  }
+
+  Parameters decodeParameters(const v8::Local<v8::Value> & descriptor) {
+    if(!descriptor->IsObject()){
+        throw std::runtime_error("descriptor not an Object");
+    }
+
+    auto obj = ToV8<v8::Object>(descriptor);
+
+    Parameters p;
+
+    p.numberOfPaymentsMade = decodeNumber(obj, NUMBER_OF_PAYMENTS_MADE_KEY);
+    p.refundLockTime = decodeNumber(obj, REFUND_LOCK_TIME_KEY);
+    p.price = decodeNumber(obj, PRICE_KEY);
+    p.funds = decodeNumber(obj, FUNDS_KEY);
+    p.settlementFee = decodeNumber(obj, SETTLEMENT_FEE_KEY);
+    p.contractOutPoint = outpoint::decode(GET_VAL(obj, CONTRACT_OUTPOINT_KEY));
+    p.payeeContractPrivKey = private_key::decode(GET_VAL(obj, PAYEE_CONTRACT_SK_KEY));
+    p.payeeFinalPkHash = pubkey_hash::decode(GET_VAL(obj, PAYEE_FINAL_PK_HASH_KEY));
+    p.payorContractPk = public_key::decode(GET_VAL(obj, PAYOR_CONTRACT_PK_KEY));
+    p.payorFinalPkHash = pubkey_hash::decode(GET_VAL(obj, PAYOR_FINAL_PK_HASH_KEY));
+    p.lastValidPayorPaymentSignature = signature::decode(GET_VAL(obj, LAST_VALID_PAYOR_PAYMENT_SIGNATURE_KEY));
+
+    return p;
+  }
+
+  Coin::Transaction settlementTransaction(const Parameters & p) {
+
+    paymentchannel::Payee payee(p.numberOfPaymentsMade,
+                                Coin::RelativeLockTime::fromTimeUnits(p.refundLockTime),
+                                p.price,
+                                p.funds,
+                                p.settlementFee,
+                                p.contractOutPoint,
+                                Coin::KeyPair(p.payeeContractPrivKey),
+                                p.payeeFinalPkHash,
+                                p.payorContractPk,
+                                p.payorFinalPkHash,
+                                p.lastValidPayorPaymentSignature);
+
+    return payee.lastPaymentTransaction();
+  }
+
 } // settlement namespace
 
 }}}
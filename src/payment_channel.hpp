@@ -21,6 +21,23 @@ namespace commitment {
      */
     NAN_METHOD(CommitmentToOutput);
 
+    /* @brief Same as CommitmentToOutput, but key derivation happens on
+     * the libuv thread pool, and result is passed to callback.
+     * @param {Object} commitment - same as CommitmentToOutput
+     * @param {Function} callback - (err, node Buffer)
+     * @thows TypeError if commitment cannot be decoded
+     */
+    NAN_METHOD(CommitmentToOutputAsync);
+
+    /* @brief Converts many commitments to contract outputs in parallel on the
+     * libuv thread pool, deriving the public key of each distinct payorSk only once.
+     * @param {Array} commitments - same as argument of CommitmentToOutput
+     * @param {Function} callback - (err, r) where, for the ith commitment, r.results[i] is the raw
+     *  output node Buffer and r.errors[i] null, or r.results[i] is null and r.errors[i] an Error
+     * @throws TypeError if commitments is not an array
+     */
+    NAN_METHOD(CommitmentsToOutputs);
+
     /* @brief Converts a JavaScript Object
      * to a native paymentchannel::Commitment
      * @param {v8::Local<v8::Value>}
@@ -36,6 +53,25 @@ namespace settlement {
    * @throws Error if constructor of transaction fails
    */
   NAN_METHOD(CreateSettlementTransaction);
+
+  /* @brief Same as CreateSettlementTransaction, but transaction is built
+   * and signed on the libuv thread pool, and result is passed to callback.
+   * @param ... - same as CreateSettlementTransaction
+   * @param {Function} callback - (err, raw transaction node Buffer), last argument
+   * @throws TypeError if arguments cannot be decoded
+   */
+  NAN_METHOD(CreateSettlementTransactionAsync);
+
+  /* @brief Constructs settlement transactions of many payment channels in parallel
+   * on the libuv thread pool, where a bad channel only fails its own transaction.
+   * @param {Array} descriptors - each d an Object with the arguments of CreateSettlementTransaction
+   *  as keys: numberOfPaymentsMade, refundLockTime, price, funds, settlementFee, contractOutPoint,
+   *  payeeContractPrivKey, payeeFinalPkHash, payorContractPk, payorFinalPkHash, lastValidPayorPaymentSignature
+   * @param {Function} callback - (err, r) where, for the ith descriptor, r.results[i] is the raw
+   *  transaction node Buffer and r.errors[i] null, or r.results[i] is null and r.errors[i] an Error
+   * @throws TypeError if descriptors is not an array
+   */
+  NAN_METHOD(CreateSettlementTransactions);
 }
 
 }}}
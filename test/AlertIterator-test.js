@@ -0,0 +1,107 @@
+/* global it, describe, beforeEach */
+var AlertIterator = require('../dist/AlertIterator')
+var assert = require('chai').assert
+var sinon = require('sinon')
+
+describe('AlertIterator class', function () {
+
+  // Mock session
+  var session
+
+  beforeEach(function () {
+    session = {
+      _removeAlertIterator: sinon.spy()
+    }
+  })
+
+  it('Alerts pushed are iterated in order', function () {
+    var iterator = new AlertIterator(session)
+
+    iterator._push('a')
+    iterator._push('b')
+
+    return iterator.next().then((first) => {
+      assert.deepEqual(first, {value: 'a', done: false})
+      return iterator.next()
+    }).then((second) => {
+      assert.deepEqual(second, {value: 'b', done: false})
+    })
+  })
+
+  it('Waiting consumer gets next alert pushed', function () {
+    var iterator = new AlertIterator(session)
+    var next = iterator.next()
+
+    iterator._push('a')
+
+    assert.equal(iterator.length, 0)
+
+    return next.then((result) => {
+      assert.deepEqual(result, {value: 'a', done: false})
+    })
+  })
+
+  it('Oldest alerts are dropped and counted beyond highWaterMark', function () {
+    var iterator = new AlertIterator(session, {highWaterMark: 2})
+
+    iterator._push('a')
+    iterator._push('b')
+    assert.equal(iterator.dropped, 0)
+
+    iterator._push('c')
+    assert.equal(iterator.length, 2)
+    assert.equal(iterator.dropped, 1)
+
+    return iterator.next().then((result) => {
+      assert.equal(result.value, 'b')
+    })
+  })
+
+  it('Filter selects alerts buffered', function () {
+    var iterator = new AlertIterator(session, {filter: (alert) => alert.type === 1})
+
+    iterator._push({type: 1})
+    iterator._push({type: 2})
+
+    assert.equal(iterator.length, 1)
+  })
+
+  it('Return ends iteration and removes iterator from session', function () {
+    var iterator = new AlertIterator(session)
+    var pending = iterator.next()
+
+    return iterator.return().then((result) => {
+      assert.isTrue(result.done)
+      assert(session._removeAlertIterator.calledWith(iterator))
+
+      iterator._push('a')
+      assert.equal(iterator.length, 0)
+
+      return pending
+    }).then((result) => {
+      assert.isTrue(result.done)
+    })
+  })
+
+  it('Buffer is compacted as alerts are consumed', function () {
+    var iterator = new AlertIterator(session, {highWaterMark: 5000})
+    var consumed = []
+
+    for (var i = 0; i < 3000; i++) {
+      iterator._push(i)
+    }
+
+    for (var j = 0; j < 2000; j++) {
+      iterator.next().then((result) => consumed.push(result.value))
+    }
+
+    assert.equal(iterator.length, 1000)
+    assert.isBelow(iterator._buffer.length, 3000)
+
+    return iterator.next().then((result) => {
+      assert.equal(result.value, 2000)
+      assert.equal(consumed.length, 2000)
+      assert.equal(consumed[1999], 1999)
+    })
+  })
+})
@@ -0,0 +1,47 @@
+/* global it, describe */
+var lib = require('../')
+var JoyStreamAddon = require('bindings')('JoyStreamAddon').joystream
+var assert = require('chai').assert
+
+describe('Metrics', function () {
+  var layout = lib.metricsLayout()
+
+  it('Buckets below 8 hold one value each, and 8 buckets split each power of two above', function () {
+    const bounds = Array.from(layout.bucketLowerBounds)
+
+    assert.deepEqual(bounds.slice(0, 16), [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15])
+    assert.deepEqual(bounds.slice(16, 24), [16, 18, 20, 22, 24, 26, 28, 30])
+    assert.deepEqual(bounds.slice(24, 32), [32, 36, 40, 44, 48, 52, 56, 60])
+
+    for (var b = 1; b < bounds.length; b++) {
+      assert.isBelow(bounds[b - 1], bounds[b])
+    }
+  })
+
+  it('Histograms have count, sum, min, max and buckets', function () {
+    assert.equal(layout.stride, 4 + layout.bucketLowerBounds.length)
+
+    const snapshot = lib.metrics()
+
+    assert.equal(snapshot.counters.length, layout.counters.length)
+    assert.equal(snapshot.histograms.length, layout.histograms.length * layout.stride)
+  })
+
+  it('End of alert pop is recorded once per call', function () {
+    // Plugin not added to a session encodes no alerts
+    var plugin = new JoyStreamAddon.Plugin(60)
+
+    const pops = layout.counters.indexOf('alert_pops')
+    const perPop = layout.histograms.indexOf('alerts_per_pop') * layout.stride
+
+    const before = lib.metrics()
+    plugin.alert_pop_ended()
+    const after = lib.metrics()
+
+    assert.equal(after.counters[pops] - before.counters[pops], 1)
+
+    // Count, and bucket of pops with no alerts
+    assert.equal(after.histograms[perPop] - before.histograms[perPop], 1)
+    assert.equal(after.histograms[perPop + 4] - before.histograms[perPop + 4], 1)
+  })
+})
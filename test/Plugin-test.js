@@ -0,0 +1,74 @@
+/* global it, describe */
+var lib = require('../')
+var JoyStreamAddon = require('bindings')('JoyStreamAddon').joystream
+var assert = require('chai').assert
+
+const minimumMessageId = 60
+const infoHash = '6a9759bffd5c0af65319979fb7832189f4f3c35d'
+
+describe('Plugin class', function () {
+
+  // Plugin not added to a session, requests are queued but never run
+  var plugin = new JoyStreamAddon.Plugin(minimumMessageId)
+
+  describe('Completion of requests', function () {
+    it('Returns a promise when callback is omitted', function () {
+      assert.instanceOf(plugin.stop(infoHash), Promise)
+      assert.instanceOf(plugin.to_observe_mode(infoHash, undefined), Promise)
+    })
+
+    it('Returns nothing when callback is given', function () {
+      assert.isUndefined(plugin.stop(infoHash, () => {}))
+    })
+
+    it('Callback must be a function', function () {
+      assert.throws(() => plugin.stop(infoHash, 5), TypeError)
+    })
+  })
+
+  describe('Batch of requests', function () {
+    it('Requests must be a non empty array', function () {
+      assert.throws(() => plugin.submit_batch({}), TypeError)
+      assert.throws(() => plugin.submit_batch([]), TypeError)
+    })
+
+    it('Malformed request rejects whole batch', function () {
+      const requests = [
+        {method: 'stop', args: [infoHash]},
+        {method: 'no_such_method', args: [infoHash]}
+      ]
+
+      assert.throws(() => plugin.submit_batch(requests), TypeError, /Request 1: unsupported method/)
+      assert.throws(() => plugin.submit_batch([{method: 'stop', args: infoHash}]), TypeError, /Request 0: args must be array/)
+      assert.throws(() => plugin.submit_batch([{method: 'pause_torrent', args: [infoHash, 'false']}]), TypeError, /Request 0: argument must be a boolean/)
+    })
+
+    it('Returns a promise when callback is omitted', function () {
+      const requests = [
+        {method: 'stop', args: [infoHash]},
+        {method: 'to_observe_mode', args: [infoHash]}
+      ]
+
+      assert.instanceOf(plugin.submit_batch(requests), Promise)
+      assert.isUndefined(plugin.submit_batch(requests, () => {}))
+    })
+  })
+
+  describe('Piece latency tracing', function () {
+    it('Stages are exported', function () {
+      assert.deepEqual(lib.PieceLatencyStage, {RequestToSend: 0, SendToPayment: 1, ArrivalToPayment: 2})
+    })
+
+    it('Nothing to take without samples', function () {
+      plugin.set_piece_tracing(true)
+      assert.isUndefined(plugin.take_piece_latency_samples())
+
+      plugin.set_piece_tracing(false)
+      assert.isUndefined(plugin.take_piece_latency_samples())
+    })
+
+    it('Enabling requires a boolean', function () {
+      assert.throws(() => plugin.set_piece_tracing())
+    })
+  })
+})
@@ -1,6 +1,43 @@
 /* global it, describe */
 var lib = require('../')
+var Libtorrent = require('bindings')('JoyStreamAddon').libtorrent
+var Torrent = require('../dist/Torrent')
 var assert = require('assert')
+var sinon = require('sinon')
+var EventEmitter = require('events')
+
+// Session with mocked libtorrent session and plugin, where a pop
+// gives alerts and routed groups given
+function mockedSession (alerts, routed) {
+  var session = Object.create(lib.Session.prototype)
+  EventEmitter.call(session)
+
+  session.session = { popAlerts: () => alerts }
+  session.plugin = {
+    alert_pop_ended: sinon.spy(),
+    take_routed_alerts: sinon.spy(() => routed),
+    run_request_results: sinon.spy(),
+    recycle_torrent_slots: sinon.spy()
+  }
+
+  session.torrents = new Map()
+  session.torrentsBySecondaryHash = new Map()
+  session._torrentsBySlot = []
+  session._routedGroups = new Map()
+  session._alertIterators = new Set()
+
+  return session
+}
+
+function mockedTorrent (session, infoHash, slot) {
+  var torrent = new Torrent({ infoHash: () => infoHash }, session.plugin)
+
+  torrent._slot = slot
+  session.torrents.set(infoHash, torrent)
+  session._torrentsBySlot[slot] = torrent
+
+  return torrent
+}
 
 describe('Session class', function () {
   describe('Adding torrent to plugin', function () {
@@ -104,4 +141,203 @@ describe('Session class', function () {
       assert(!this.torrentsBySecondaryHash.has(torrent.secondaryInfoHash))
     })
   })
+  describe('Torrent slots', function () {
+    it('Torrent is found by slot, which is reused once torrent is removed', function (done) {
+      var app = new lib.Session({
+        port: 6881
+      })
+
+      app.addTorrent({ ti: new lib.TorrentInfo(__dirname + '/sintel.torrent'), savePath: __dirname }, (err, torrent) => {
+        assert(!err)
+
+        const slot = app.plugin.torrent_slot(torrent.infoHash)
+
+        assert.strictEqual(slot, 0)
+        assert.strictEqual(app._torrentsBySlot[slot], torrent)
+
+        app.removeTorrent(torrent.infoHash, () => {
+          assert.strictEqual(app.plugin.torrent_slot(torrent.infoHash), undefined)
+          assert.strictEqual(app._torrentsBySlot[slot], undefined)
+
+          app.addTorrent({ ti: new lib.TorrentInfo(__dirname + '/sfc.torrent'), savePath: __dirname }, (err, other) => {
+            assert(!err)
+            assert.strictEqual(app.plugin.torrent_slot(other.infoHash), slot)
+            assert.strictEqual(app._torrentsBySlot[slot], other)
+            done()
+          })
+        })
+      })
+    })
+
+    it('Unknown torrent has no slot', function () {
+      var app = new lib.Session({
+        port: 6881
+      })
+
+      assert.strictEqual(app.plugin.torrent_slot('6a9759bffd5c0af65319979fb7832189f4f3c35d'), undefined)
+    })
+
+    it('Slots are recycled once every pop', function () {
+      var session = mockedSession([], null)
+
+      session._popAlerts()
+
+      assert(session.plugin.recycle_torrent_slots.calledOnce)
+    })
+  })
+  describe('Alert routing', function () {
+    const infoHash = '6a9759bffd5c0af65319979fb7832189f4f3c35d'
+
+    it('Routed alerts are delivered to their torrent after other alerts', function () {
+      var events = []
+      var sentPayment = { type: lib.AlertType.SentPayment }
+      var session = mockedSession([{ type: -1 }], [{ torrentSlot: 3, alerts: [sentPayment] }])
+      var torrent = mockedTorrent(session, infoHash, 3)
+
+      session.process = () => events.push('process')
+      torrent.on('alerts', (alerts) => events.push(alerts))
+      torrent.on('sentPayment', (alert) => events.push(alert))
+
+      session._popAlerts()
+
+      assert.deepEqual(events, ['process', [sentPayment], sentPayment])
+    })
+
+    it('Torrent removed in same pop gets its routed alerts before removal', function () {
+      var events = []
+      var removed = { type: Libtorrent.AlertType.torrent_removed_alert, infoHash: infoHash }
+      var session = mockedSession([removed], [{ torrentSlot: 0, alerts: [{ type: -1 }] }])
+      var torrent = mockedTorrent(session, infoHash, 0)
+
+      torrent.on('alerts', () => events.push('alerts'))
+      session.on('torrent_removed', () => events.push('torrent_removed'))
+
+      session._popAlerts()
+
+      assert.deepEqual(events, ['alerts', 'torrent_removed'])
+      assert.strictEqual(session._torrentsBySlot[0], undefined)
+    })
+
+    it('Alerts of torrents without slot are dropped', function () {
+      var session = mockedSession([], [{ torrentSlot: 5, alerts: [{ type: -1 }] }])
+
+      session._popAlerts()
+
+      assert.strictEqual(session._routedGroups.size, 0)
+    })
+
+    it('Alerts are popped whatever the pace of iterators', function () {
+      var session = mockedSession([{ type: -1 }, { type: -1 }], null)
+      var iterator = session.alerts({ highWaterMark: 1 })
+
+      session.process = sinon.spy()
+
+      session._popAlerts()
+      session._popAlerts()
+
+      assert.strictEqual(session.process.callCount, 4)
+      assert.strictEqual(iterator.length, 1)
+      assert.strictEqual(iterator.dropped, 3)
+    })
+
+    it('Iterators get routed alerts after other alerts of pop', function () {
+      var first = { type: -1 }
+      var routed = { type: -2 }
+      var session = mockedSession([first], [{ torrentSlot: 0, alerts: [routed] }])
+
+      mockedTorrent(session, infoHash, 0)
+      session.process = () => {}
+
+      var iterator = session.alerts()
+
+      session._popAlerts()
+
+      assert.deepEqual(iterator._buffer, [first, routed])
+    })
+  })
+  describe('Batch of requests', function () {
+    it('Returns promise of plugin when callback is omitted', function () {
+      var session = mockedSession([], null)
+      var promise = Promise.resolve({ results: [], errors: [] })
+
+      session.plugin.submit_batch = sinon.spy(() => promise)
+
+      assert.strictEqual(session.submitBatch([]), promise)
+    })
+  })
+  describe('Request results', function () {
+    it('Run as their alert is processed unless coalesced', function () {
+      var session = mockedSession([{ type: -1 }], null)
+
+      session.process = () => {}
+      session._popAlerts()
+
+      assert(!session.plugin.run_request_results.called)
+    })
+
+    it('Run once alerts popped with them are processed', function () {
+      var events = []
+      var session = mockedSession([{ type: -1 }], [{ torrentSlot: 0, alerts: [{ type: -1 }] }])
+      var torrent = mockedTorrent(session, '6a9759bffd5c0af65319979fb7832189f4f3c35d', 0)
+
+      session._coalesceRequestResults = true
+      session.process = () => events.push('process')
+      torrent.on('alerts', () => events.push('alerts'))
+      session.plugin.run_request_results = () => events.push('results')
+
+      session._popAlerts()
+
+      assert.deepEqual(events, ['process', 'alerts', 'results'])
+    })
+  })
+  describe('Piece latency tracing', function () {
+    it('Samples are emitted after pop only when tracing', function () {
+      var samples = { latency: new Float64Array(1) }
+      var session = mockedSession([], null)
+      var emitted = sinon.spy()
+
+      session.plugin.take_piece_latency_samples = () => samples
+      session.on('pieceLatencySamples', emitted)
+
+      session._popAlerts()
+      assert(!emitted.called)
+
+      session._tracePieceLatency = true
+      session._popAlerts()
+      assert(emitted.calledOnce)
+      assert(emitted.calledWith(samples))
+    })
+  })
+  describe('Status deltas', function () {
+    it('Change of buyer terms is delivered', function (done) {
+      this.timeout(10000)
+
+      var app = new lib.Session({
+        port: 6881,
+        deltaStatusUpdates: true,
+        statusUpdateInterval: 100
+      })
+
+      const terms = { maxPrice: 20, maxLock: 5, minNumberOfSellers: 1, maxContractFeePerKb: 20000 }
+
+      app.addTorrent({ ti: new lib.TorrentInfo(__dirname + '/sintel.torrent'), savePath: __dirname }, (err, torrent) => {
+        assert(!err)
+
+        torrent.toBuyMode(terms, (err) => {
+          assert(!err)
+
+          // Mode and state are unchanged, so only the new terms can produce this delta
+          torrent.on('pluginStatusUpdate', (status) => {
+            if (status.session.buying && status.session.buying.terms.maxPrice === 30) {
+              done()
+            }
+          })
+
+          torrent.updateBuyerTerms(Object.assign({}, terms, { maxPrice: 30 }), (err) => {
+            assert(!err)
+          })
+        })
+      })
+    })
+  })
 })